@@ -0,0 +1,94 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <fmt/core.h>
+
+#include "model/data.h"
+#include "model/batch.h"
+#include "model/analysis.h"
+
+// throughput of the batched engine: generates a batch of expert boards and plays every
+// board with a random clicker until all of them ended. prints one json object per line
+// usage: MinesweeperBenchModel [boards] [repeats]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const int32_t count = (argc > 1) ? std::atoi(argv[1]) : 4096;
+    const int32_t repeats = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    GameSettings settings;
+    settings.row_size = 16;
+    settings.col_size = 30;
+    settings.num_mines = 99;
+    settings.is_safe_first_move = true;
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int32_t> row_dist(0, settings.row_size - 1);
+    std::uniform_int_distribution<int32_t> col_dist(0, settings.col_size - 1);
+    std::vector<GameBoardCoord> coords(count);
+
+    for (int32_t repeat = 0; repeat < repeats; repeat++) {
+        settings.seed = repeat;
+        GameBatch batch(settings, count);
+        for (GameBoardCoord& coord : coords)
+            coord = { row_dist(rng), col_dist(rng) };
+
+        const Clock::time_point generate_start = Clock::now();
+        if (!batch.generateMines(coords)) {
+            fmt::print(stderr, "{} mines do not fit a {}x{} board\n", settings.num_mines, settings.row_size, settings.col_size);
+            return 1;
+        }
+        const double generate_time = secondsSince(generate_start);
+
+        std::vector<BoardMetrics> metrics;
+        const Clock::time_point metrics_start = Clock::now();
+        measureBatch(batch, metrics);
+        const double metrics_time = secondsSince(metrics_start);
+
+        // clicks that land on revealed squares are no-ops, so a board may take a few
+        // extra rounds, which is part of what is measured
+        int64_t rounds = 0;
+        int32_t playing = count;
+        const Clock::time_point reveal_start = Clock::now();
+        while (playing > 0) {
+            batch.reveal(coords);
+            rounds++;
+            playing = 0;
+            for (int32_t b = 0; b < count; b++) {
+                if (batch.status()[b] != BatchStatus::Playing) {
+                    coords[b].row = -1;
+                    continue;
+                }
+                coords[b] = { row_dist(rng), col_dist(rng) };
+                playing++;
+            }
+        }
+        const double reveal_time = secondsSince(reveal_start);
+
+        int32_t won = 0;
+        for (BatchStatus status : batch.status())
+            won += (status == BatchStatus::Won);
+
+        fmt::print(
+            "{{\"boards\": {}, \"generate_s\": {:.6f}, \"boards_per_s\": {:.0f}, \"metrics_s\": {:.6f}, "
+            "\"rounds\": {}, \"reveal_s\": {:.6f}, \"reveals_per_s\": {:.0f}, \"won\": {}}}\n",
+            count, generate_time, count / generate_time, metrics_time,
+            rounds, reveal_time, rounds * count / reveal_time, won
+        );
+    }
+
+    return 0;
+}
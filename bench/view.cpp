@@ -0,0 +1,175 @@
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <QApplication>
+#include <fmt/core.h>
+
+#include "view/game.h"
+#include "model/data.h"
+#include "model/board.h"
+
+// cost of the view layer: builds a GameView on the offscreen platform (unless another
+// platform is asked for) and times board construction, rendering after a large flood
+// fill, chord preview cycles, style sheet repolishing and zooming (buttons against the
+// scalable canvas, see GameView::setScalable). every step is followed by a
+// synchronous repaint, so painting is part of the numbers. prints one json object per line
+// usage: MinesweeperBenchView [repeats]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    GameSettings boardSettings(int32_t rows, int32_t cols, int32_t mines) {
+        GameSettings settings;
+        settings.row_size = rows;
+        settings.col_size = cols;
+        settings.num_mines = mines;
+        settings.is_set_seed = true;
+        settings.seed = 1;
+        settings.is_clear_first_move = true;
+        settings.is_safe_first_move = true;
+        return settings;
+    }
+
+    // lets layouts and deferred work run, then paints everything at once
+    void settle(GameView& view) {
+        QApplication::sendPostedEvents();
+        QApplication::processEvents();
+        view.repaint();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    const int32_t repeats = (argc > 1) ? std::atoi(argv[1]) : 5;
+    const std::vector<GameSettings> sizes = {
+        boardSettings(9, 9, 10),
+        boardSettings(16, 16, 40),
+        boardSettings(16, 30, 99),
+        boardSettings(30, 60, 360),
+        boardSettings(60, 60, 720)
+    };
+
+    for (int32_t repeat = 0; repeat < repeats; repeat++) {
+        // a new view has to create every button, a view that showed a larger board before
+        // only lays out the pooled ones
+        GameView pooled(GameBoard(sizes.back()));
+        pooled.initBoard(GameBoard(sizes.back()), GameState(), true);
+        pooled.show();
+        settle(pooled);
+        for (const GameSettings& settings : sizes) {
+            const GameBoard board(settings);
+            GameView view(board);
+            view.show();
+            const Clock::time_point cold_start = Clock::now();
+            view.initBoard(board, GameState(), true);
+            settle(view);
+            const double cold_time = msSince(cold_start);
+
+            const Clock::time_point warm_start = Clock::now();
+            pooled.initBoard(board, GameState(), true);
+            settle(pooled);
+            const double warm_time = msSince(warm_start);
+
+            fmt::print(
+                "{{\"case\": \"init_board\", \"rows\": {}, \"cols\": {}, \"cold_ms\": {:.3f}, \"pooled_ms\": {:.3f}}}\n",
+                settings.row_size, settings.col_size, cold_time, warm_time
+            );
+        }
+
+        // few mines, so the first reveal opens nearly the whole board
+        const GameSettings settings = boardSettings(60, 60, 20);
+        GameBoard board(settings);
+        GameState state;
+        state.mines = settings.num_mines;
+        GameView view(board);
+        view.initBoard(board, state, true);
+        view.show();
+        settle(view);
+
+        board.reveal({ settings.row_size / 2, settings.col_size / 2 }, state);
+        int32_t revealed = 0;
+        GameBoardCoord number = { -1, -1 };
+        for (int32_t i = 0; i < board.rowSize(); i++) {
+            for (int32_t j = 0; j < board.colSize(); j++) {
+                const GameBoardSquare& square = board.getSquare({ i, j });
+                revealed += square.is_revealed;
+                if (square.is_revealed && square.adjacent_mines && number.row < 0)
+                    number = { i, j };
+            }
+        }
+
+        const Clock::time_point flood_start = Clock::now();
+        view.updateBoard(board, state);
+        settle(view);
+        fmt::print(
+            "{{\"case\": \"update_after_flood\", \"rows\": {}, \"cols\": {}, \"revealed\": {}, \"ms\": {:.3f}}}\n",
+            settings.row_size, settings.col_size, revealed, msSince(flood_start)
+        );
+
+        // what the gui does between pressing and releasing a number
+        const int32_t cycles = 100;
+        const Clock::time_point chord_start = Clock::now();
+        for (int32_t k = 0; k < cycles && number.row >= 0; k++) {
+            board.revealAdjacentDown(number);
+            view.updateBoard(board, state);
+            settle(view);
+            board.revealAdjacentUp();
+            view.updateBoard(board, state);
+            settle(view);
+        }
+        fmt::print(
+            "{{\"case\": \"chord_preview\", \"cycles\": {}, \"ms_per_cycle\": {:.3f}}}\n",
+            cycles, msSince(chord_start) / cycles
+        );
+
+        // setting any style sheet on the window unpolishes and polishes all its children
+        const int32_t polishes = 10;
+        const Clock::time_point polish_start = Clock::now();
+        for (int32_t k = 0; k < polishes; k++) {
+            view.setStyleSheet((k % 2) ? QString() : QString("QMainWindow {}"));
+            settle(view);
+        }
+        fmt::print(
+            "{{\"case\": \"repolish\", \"rows\": {}, \"cols\": {}, \"ms\": {:.3f}}}\n",
+            settings.row_size, settings.col_size, msSince(polish_start) / polishes
+        );
+
+        // a zoom step: the scalable view repaints from its atlas (the sizes repeat, so
+        // after the first round every atlas is cached), the button view has to lay out
+        // every button again
+        GameView scalable(board);
+        scalable.setScalable(24);
+        scalable.initBoard(board, state, true);
+        scalable.show();
+        settle(scalable);
+        const int32_t zooms = 20;
+        const Clock::time_point canvas_start = Clock::now();
+        for (int32_t k = 0; k < zooms; k++) {
+            scalable.setScalable(20 + 2 * (k % 4));
+            settle(scalable);
+        }
+        const double canvas_time = msSince(canvas_start) / zooms;
+
+        const Clock::time_point buttons_start = Clock::now();
+        for (int32_t k = 0; k < zooms; k++) {
+            view.initBoard(board, state, true);
+            settle(view);
+        }
+        fmt::print(
+            "{{\"case\": \"zoom\", \"rows\": {}, \"cols\": {}, \"canvas_ms\": {:.3f}, \"buttons_ms\": {:.3f}}}\n",
+            settings.row_size, settings.col_size, canvas_time, msSince(buttons_start) / zooms
+        );
+    }
+
+    return 0;
+}
@@ -1,5 +1,15 @@
+#include <vector>
+#include <algorithm>
+
 #include <QApplication>
+#include <QClipboard>
+#include <QCommandLineParser>
+#include <QDateTime>
 #include <QDesktopServices>
+#include <QDir>
+#include <QFileDialog>
+#include <QFile>
+#include <QStandardPaths>
 #include <QTimer>
 #include <QUrl>
 #include <fmt/format.h>
@@ -8,9 +18,14 @@
 #include "view/game.h"
 #include "view/about.h"
 #include "view/options.h"
+#include "view/leaderboard.h"
 #include "model/board.h"
+#include "model/code.h"
+#include "model/snapshot.h"
 #include "utils/config.h"
 
+static constexpr int32_t s_save_interval_ms = 30 * 1000;
+
 // {0} = thick border size
 // {1} = thin border size
 // {2} = vertical spacing (control widget)
@@ -167,6 +182,24 @@ App::App(int argc, char** argv) : QApplication(argc, argv) {
     m_game_window->show();
 
     setupLCD();
+
+    m_data_path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!QDir().mkpath(m_data_path) || !m_leaderboard.open(m_data_path + "/leaderboard.mslb"))
+        LOG_WARN("app: could not open the leaderboard in {}", m_data_path.toStdString());
+
+    // all game logic runs on the worker thread; the gui only posts actions and renders
+    // the updates that the worker publishes
+    m_worker = new BoardWorker(m_settings);
+    m_worker->moveToThread(&m_worker_thread);
+    connect(&m_worker_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &BoardWorker::published, this, &App::onBoardPublished, Qt::QueuedConnection);
+    m_worker_thread.start();
+    parseCommandLine();
+
+    m_save_timer = new QTimer(this);
+    m_save_timer->callOnTimeout(this, [this] { saveGame(false); });
+    m_save_timer->start(s_save_interval_ms);
+    m_estimator = new WinRateEstimator(this);
     
     // registering events (signal/slots)
     connect(m_game_window, &GameView::restart, this, &App::onRestart);
@@ -175,9 +208,15 @@ App::App(int argc, char** argv) : QApplication(argc, argv) {
     connect(m_game_window, &GameView::revealAltDown, this, &App::onRevealAltDown);
     connect(m_game_window, &GameView::revealAltUp, this, &App::onRevealAltUp);
     connect(m_game_window, &GameView::actionAbout, this, &App::onActionAbout);
+    connect(m_game_window, &GameView::actionUndo, this, &App::onActionUndo);
+    connect(m_game_window, &GameView::actionRedo, this, &App::onActionRedo);
     connect(m_game_window, &GameView::actionBeginner, this, &App::onActionBeginner);
     connect(m_game_window, &GameView::actionIntermediate, this, &App::onActionIntermediate);
     connect(m_game_window, &GameView::actionAdvanced, this, &App::onActionAdvanced);
+    connect(m_game_window, &GameView::actionCopyCode, this, &App::onActionCopyCode);
+    connect(m_game_window, &GameView::actionExportMines, this, &App::onActionExportMines);
+    connect(m_game_window, &GameView::actionImportMines, this, &App::onActionImportMines);
+    connect(m_game_window, &GameView::actionLeaderboard, this, &App::onActionLeaderboard);
     connect(m_game_window, &GameView::actionOptions, this, &App::onActionOptions);
     connect(m_game_window, &GameView::actionGithub, this, &App::onActionGithub);
     connect(m_game_window, &GameView::actionTutorial, this, &App::onActionTutorial);
@@ -187,76 +226,354 @@ App::App(int argc, char** argv) : QApplication(argc, argv) {
 }
 
 App::~App() {
+    saveGame(true);
+    m_worker_thread.quit();
+    m_worker_thread.wait();
+    LOG_DEBUG("app: stopped worker thread");
     delete m_game_window;
     LOG_DEBUG("app: deallocated window object");
     LOG_DEBUG("app: terminated event loop");
 }
 
+void App::parseCommandLine() {
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption code_option("code", "Start with the board of a board code.", "code");
+    const QCommandLineOption mines_option("mines", "Start with the mines of a mine bitmap file.", "file");
+    const QCommandLineOption script_option("script", "Play the commands of a script file (- for stdin) and exit.", "file");
+    const QCommandLineOption race_option("race", "Join the race of a race server.", "host:port");
+    const QCommandLineOption tile_option("tile-size", "Draw the board on one canvas that Ctrl+wheel or a pinch zooms, starting with tiles of this many pixels.", "pixels");
+    parser.addOption(code_option);
+    parser.addOption(mines_option);
+    parser.addOption(script_option);
+    parser.addOption(race_option);
+    parser.addOption(tile_option);
+    parser.process(arguments());
+
+    if (parser.isSet(tile_option)) {
+        m_game_window->setScalable(parser.value(tile_option).toInt());
+        m_game_window->initBoard(m_board, m_state, true);
+    }
+
+    if (parser.isSet(code_option)) {
+        GameSettings settings = m_settings;
+        GameBoardCoord anchor;
+        if (decodeBoardCode(parser.value(code_option), settings, anchor)) {
+            onBoardCode(settings, anchor);
+        } else {
+            LOG_WARN("app: invalid board code {}", parser.value(code_option).toStdString());
+        }
+    }
+
+    if (parser.isSet(mines_option))
+        importMines(parser.value(mines_option));
+
+    if (parser.isSet(race_option)) {
+        m_race = new RaceClient(this);
+        connect(m_race, &RaceClient::joined, this, &App::onBoardCode);
+        connect(m_race, &RaceClient::progressed, this, &App::onRaceProgress);
+        connect(m_race, &RaceClient::finished, this, &App::onRaceFinished);
+        m_race->connectTo(parser.value(race_option));
+    }
+
+    if (parser.isSet(script_option)) {
+        // the driver reports on stdout, so the log is limited to problems
+        SET_LOG_PRIORITY(WARN_LEVEL);
+        m_driver = new ScriptDriver(*this, parser.value(script_option), this);
+    }
+
+    const bool is_board_chosen = parser.isSet(code_option) || parser.isSet(mines_option) || m_race || m_driver;
+    if (!is_board_chosen && resumeGame())
+        LOG_INFO("app: resumed the saved game");
+}
+
+bool App::resumeGame() {
+    QFile file(m_data_path + "/game.msgs");
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    GameSnapshot snapshot;
+    if (!decodeGameSnapshot(file.readAll(), snapshot)) {
+        LOG_WARN("app: the saved game is unreadable");
+        return false;
+    }
+
+    m_settings = snapshot.settings;
+    m_is_imported = snapshot.is_imported;
+    BoardAction action = { BoardActionType::Resume, { 0, 0 }, m_settings };
+    action.mines = std::move(snapshot.mines);
+    action.visible = std::move(snapshot.visible);
+    action.state = snapshot.state;
+    m_worker->post(action);
+    return true;
+}
+
+void App::saveGame(bool wait) {
+    // races and scripted runs play boards that are not the player's own game
+    if (m_race || m_driver || m_data_path.isEmpty())
+        return;
+    m_worker->save(m_data_path + "/game.msgs", elapsedMs(), m_is_imported, wait);
+}
+
+void App::importMines(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_WARN("app: could not open mine bitmap {}", path.toStdString());
+        return;
+    }
+
+    GameSettings settings = m_settings;
+    std::vector<uint8_t> bitmap;
+    if (!decodeMineBitmap(file.readAll(), settings, bitmap)) {
+        LOG_WARN("app: invalid mine bitmap {}", path.toStdString());
+        return;
+    }
+
+    m_settings = settings;
+    m_is_imported = true;
+    BoardAction action = { BoardActionType::Reset, { 0, 0 }, m_settings };
+    action.mines = std::move(bitmap);
+    m_worker->post(action);
+}
+
 void App::setupLCD() {
     delete m_timer;
     m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
     m_timer->callOnTimeout(this, &App::onTimerUpdated);
+    m_clock.invalidate();
+    m_banked_ms = 0;
     m_state.timer = 0;
     m_state.mines = m_settings.num_mines;
     m_game_window->setMinesLeft(m_state.mines);
-    m_game_window->setTimePassed(m_state.timer);
+    m_game_window->setTimePassed(0);
+}
+
+qint64 App::elapsedMs() const {
+    return m_banked_ms + (m_clock.isValid() ? m_clock.elapsed() : 0);
 }
 
 void App::onTimerUpdated() {
-    if (!m_state.won && !m_state.lost) {
-        m_state.timer++;
-        m_game_window->setTimePassed(m_state.timer);
-        m_timer->start(1000);
-    }
+    // display only. the time itself comes from the monotonic clock, so a late tick never
+    // loses time; the next tick is aimed at the next whole second
+    const qint64 elapsed = elapsedMs();
+    m_game_window->setTimePassed(elapsed / 1000);
+    if (m_clock.isValid())
+        m_timer->start(1000 - elapsed % 1000);
 }
 
 void App::onRestart() {
-    setupLCD();
-    m_state.lost = false;
-    m_state.won = false;
-    m_state.revealing_mine = false;
-    m_state.is_first_reveal = true;
+    // a race is played on the race's board only, so nothing may replace or rewind it
+    if (m_race)
+        return;
     m_settings.seed = (m_settings.is_set_seed) ? m_settings.seed : std::rand();
-
-    if (m_board.rowSize() == m_settings.row_size
-        && m_board.colSize() == m_settings.col_size) {
-        m_board.reset(m_settings);
-        m_game_window->updateBoard(m_board, m_state);
-    } else {
-        m_board.reset(m_settings);
-        m_game_window->initBoard(m_board, m_state);
-    }
+    m_is_imported = false;
+    m_worker->post({ BoardActionType::Reset, { 0, 0 }, m_settings });
 }
 
 void App::onMark(const GameBoardCoord& coord) {
-    m_board.mark(coord, m_state);
-    m_game_window->updateBoard(m_board, m_state);
-    m_game_window->setMinesLeft(m_state.mines);
+    m_worker->post({ BoardActionType::Mark, coord });
+    if (m_race)
+        m_race->send(RaceMove::Mark, coord);
 }
 
 void App::onReveal(const GameBoardCoord& coord) {
-    if (m_state.is_first_reveal) {
-        m_board.generateMines(coord);
-        m_timer->start(1000);
+    // the clock starts with the click, not when the worker is done with it, so the time
+    // of generating the board and of the first flood fill is played time too. a marked
+    // square is not revealed, so it does not start the game
+    const bool starts_game = m_state.is_first_reveal && !m_state.won && !m_state.lost
+        && !m_board.getSquare(coord).is_marked;
+    m_worker->post({ BoardActionType::Reveal, coord });
+    if (starts_game && !m_clock.isValid()) {
+        m_clock.start();
+        m_timer->start(1000 - m_banked_ms % 1000);
     }
-
-    m_board.reveal(coord, m_state);
-    m_game_window->updateBoard(m_board, m_state);
+    if (m_race)
+        m_race->send(RaceMove::Reveal, coord);
 }
 
 void App::onRevealAltDown(const GameBoardCoord& coord) {
-    m_state.revealing_mine = true;
-    m_board.revealAdjacentDown(coord);
-    m_game_window->updateBoard(m_board, m_state);
+    m_worker->post({ BoardActionType::PreviewDown, coord });
 }
 
 void App::onRevealAltUp(const GameBoardCoord& coord) {
-    m_state.revealing_mine = false;
-    m_board.revealAdjacentUp();
-    m_game_window->updateBoard(m_board, m_state);
+    m_worker->post({ BoardActionType::PreviewUp, coord });
+}
+
+void App::onBoardPublished(const BoardUpdate& update) {
+    if (update.is_reset) {
+        // restarting the same size only resets the squares; a new size needs new buttons
+        const bool same_size = m_board.rowSize() == update.settings.row_size
+            && m_board.colSize() == update.settings.col_size;
+        m_board.reset(update.settings);
+        m_state = update.state;
+        m_game_window->setSummary(QString());
+        setupLCD();
+        m_banked_ms = update.state.timer; // only a resumed game starts with time played
+        if (!same_size)
+            m_game_window->initBoard(m_board, m_state);
+    }
+
+    for (const GameBoardChange& change : update.changes)
+        m_board.getSquare(change.coord) = change.square;
+    const bool was_over = m_state.won || m_state.lost;
+    m_state = update.state;
+    resumeTimer(); // the worker does not keep time, this also fills in the timer
+    if (m_state.won || m_state.lost) {
+        if (!was_over)
+            showSummary(update.metrics);
+    } else if (was_over) {
+        m_game_window->setSummary(QString()); // an undo reopened the game
+    }
+
+    m_game_window->scheduleUpdate(m_board, m_state, update.changes, update.is_reset);
+    m_game_window->setMinesLeft(m_state.mines);
+}
+
+void App::showSummary(const BoardMetrics& metrics) {
+    const GameEfficiency efficiency = measureEfficiency(metrics, m_state);
+    LOG_INFO("app: game ended, 3bv {}, {} openings, {} isolated, difficulty {:.2f}",
+        metrics.bbbv, metrics.openings, metrics.isolated, metrics.difficulty);
+    if (m_race)
+        return; // the server decides how a race ended, see onRaceProgress
+    m_statistics.record(m_settings, m_state);
+    if (!m_state.won) {
+        m_game_window->setSummary(QString::fromStdString(fmt::format("3BV {}", metrics.bbbv)));
+        return;
+    }
+
+    // every win is kept, the best times are a query over them
+    LeaderboardEntry entry = {};
+    entry.key = { leaderboardConfig(m_settings), uint32_t(m_state.timer), 0 };
+    entry.date = QDateTime::currentSecsSinceEpoch();
+    entry.clicks = std::min(m_state.clicks, int(UINT16_MAX));
+    entry.bbbv = std::min(metrics.bbbv, int32_t(UINT16_MAX));
+    // boards too large for a code are kept without one, like imported boards
+    if (!m_is_imported) {
+        const QByteArray code = encodeBoardCode(m_settings, { m_state.first_row, m_state.first_col }).toLatin1();
+        std::copy_n(code.constData(), std::min<qsizetype>(code.size(), sizeof(entry.code) - 1), entry.code);
+    }
+    const int64_t rank = m_leaderboard.insert(entry);
+    const std::string placing = rank ? fmt::format(" | #{} of {}", rank, m_leaderboard.count(entry.key.config)) : "";
+
+    m_game_window->setSummary(QString::fromStdString(fmt::format(
+        "{:.3f}s | 3BV {} | {:.2f} 3BV/s | {:.2f} clicks/3BV{}",
+        m_state.timer / 1000.0, metrics.bbbv, efficiency.bbbv_per_second, efficiency.clicks_per_bbbv, placing
+    )));
+}
+
+void App::onRaceProgress(const RaceProgress& progress) {
+    if (progress.rejected) {
+        LOG_WARN("app: the race server rejected a move");
+        return;
+    }
+
+    if (progress.won) {
+        m_game_window->setSummary(QString::fromStdString(fmt::format(
+            "Race | #{} | {:.3f}s | {} clicks", progress.rank, progress.time_ms / 1000.0, progress.clicks
+        )));
+    } else if (progress.lost) {
+        m_game_window->setSummary("Race | lost");
+    }
+}
+
+void App::onRaceFinished(const RaceProgress& standing) {
+    LOG_INFO("app: player {} finished the race #{} in {} ms", standing.player, standing.rank, standing.time_ms);
+}
+
+void App::resumeTimer() {
+    // stops the clock when the game ends (onReveal starts it). after an undo/redo or a
+    // resumed game the game may also have left or re-entered the running state. time
+    // spent stopped is not counted, the time before is banked
+    if (m_state.is_first_reveal || m_state.won || m_state.lost) {
+        if (m_clock.isValid()) {
+            m_banked_ms += m_clock.elapsed();
+            m_clock.invalidate();
+            LOG_INFO("app: clock stopped at {} ms", m_banked_ms);
+        }
+        m_timer->stop();
+        m_game_window->setTimePassed(m_banked_ms / 1000);
+    } else if (!m_clock.isValid()) {
+        m_clock.start();
+        m_timer->start(1000 - m_banked_ms % 1000);
+    }
+
+    m_state.timer = elapsedMs();
+}
+
+void App::onActionUndo() {
+    if (m_race)
+        return;
+    m_worker->post({ BoardActionType::Undo });
+}
+
+void App::onActionRedo() {
+    if (m_race)
+        return;
+    m_worker->post({ BoardActionType::Redo });
+}
+
+void App::onBoardCode(const GameSettings& settings, const GameBoardCoord& anchor) {
+    m_settings = settings;
+    m_is_imported = false;
+    BoardAction action = { BoardActionType::Reset, { 0, 0 }, m_settings };
+    action.anchor = anchor;
+    m_worker->post(action);
+}
+
+void App::onActionCopyCode() {
+    // an imported layout did not come from a seed, so there is no code that rebuilds it
+    if (m_is_imported) {
+        LOG_WARN("app: imported boards have no board code");
+        return;
+    }
+
+    const QString code = encodeBoardCode(m_settings, { m_state.first_row, m_state.first_col });
+    if (code.isEmpty()) {
+        LOG_WARN("app: a {}x{} board with {} mines is too large for a board code", m_settings.row_size, m_settings.col_size, m_settings.num_mines);
+        return;
+    }
+    QGuiApplication::clipboard()->setText(code);
+    LOG_INFO("app: copied board code {}", code.toStdString());
+}
+
+void App::onActionExportMines() {
+    const std::vector<uint8_t> bitmap = m_board.mineBitmap();
+    if (std::all_of(bitmap.begin(), bitmap.end(), [](uint8_t byte) { return byte == 0; })) {
+        LOG_WARN("app: no mines to export before the first reveal");
+        return;
+    }
+
+    const QByteArray data = encodeMineBitmap(m_settings, bitmap);
+    if (data.isEmpty()) {
+        LOG_WARN("app: a {}x{} board with {} mines is too large for a mine bitmap", m_settings.row_size, m_settings.col_size, m_settings.num_mines);
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(m_game_window, "Export Mines", "board.msmb", "Mine Bitmaps (*.msmb)");
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::WriteOnly))
+        return;
+    file.write(data);
+}
+
+void App::onActionImportMines() {
+    if (m_race)
+        return;
+    const QString path = QFileDialog::getOpenFileName(m_game_window, "Import Mines", QString(), "Mine Bitmaps (*.msmb)");
+    if (!path.isEmpty())
+        importMines(path);
+}
+
+void App::onActionLeaderboard() {
+    LeaderboardView* window = new LeaderboardView(m_leaderboard, m_settings, m_game_window);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->exec();
 }
 
 void App::onActionBeginner() {
+    if (m_race)
+        return;
     m_settings.row_size = 9;
     m_settings.col_size = 9;
     m_settings.num_mines = 10;
@@ -264,6 +581,8 @@ void App::onActionBeginner() {
 }
 
 void App::onActionIntermediate() {
+    if (m_race)
+        return;
     m_settings.row_size = 12;
     m_settings.col_size = 20;
     m_settings.num_mines = 40;
@@ -271,6 +590,8 @@ void App::onActionIntermediate() {
 }
 
 void App::onActionAdvanced() {
+    if (m_race)
+        return;
     m_settings.row_size = 16;
     m_settings.col_size = 30;
     m_settings.num_mines = 99;
@@ -278,8 +599,15 @@ void App::onActionAdvanced() {
 }
 
 void App::onActionOptions() const {
+    if (m_race)
+        return;
     OptionsView* window = new OptionsView(m_settings, m_game_window);
     connect(window, &OptionsView::applySettings, this, &App::onOptionsChanged);
+    connect(window, &OptionsView::applyBoardCode, this, &App::onBoardCode);
+    connect(window, &OptionsView::settingsEdited, m_estimator, &WinRateEstimator::start);
+    connect(window, &QDialog::finished, m_estimator, &WinRateEstimator::cancel);
+    connect(m_estimator, &WinRateEstimator::estimated, window, &OptionsView::showEstimate);
+    m_estimator->start(m_settings);
     window->setAttribute(Qt::WA_DeleteOnClose); // makes it so that we don't have to manually
     window->exec();                             // delete the window after it closes
 }
@@ -301,7 +629,7 @@ void App::onActionAbout() {
 void App::onOptionsChanged(const GameSettings& new_settings) {
     const GameSettings old = m_settings;
     m_settings = new_settings;
-    m_board.updateSettings(new_settings);
+    m_worker->post({ BoardActionType::UpdateSettings, { 0, 0 }, m_settings });
     if (old.col_size != m_settings.col_size
         || old.row_size != m_settings.row_size
         || old.num_mines != m_settings.num_mines) {
@@ -1,19 +1,41 @@
 #pragma once
 
 #include <QApplication>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QString>
 
+#include "app/worker.h"
+#include "app/driver.h"
+#include "app/client.h"
+#include "app/estimator.h"
 #include "view/game.h"
 #include "model/data.h"
 #include "model/board.h"
+#include "model/analysis.h"
+#include "model/leaderboard.h"
 #include "model/screen.h"
 
 class App : public QApplication {
+    friend class ScriptDriver; // drives the same handlers as the view
 public:
     App(int argc, char** argv);
     ~App();
 
 private:
+    // --code <code> and --mines <file> start the game on a shared board, --script <file>
+    // plays it from a script (see ScriptDriver), --race <host:port> joins a race and
+    // --tile-size <pixels> draws the board in the scalable mode (see GameView::setScalable)
+    void parseCommandLine();
+    void importMines(const QString& path);
+    // the game in progress is saved when the app exits and every s_save_interval_ms while
+    // it runs, and resumed at the next start unless the command line picks a board
+    bool resumeGame();
+    void saveGame(bool wait);
     void setupLCD();
+    void resumeTimer();
+    qint64 elapsedMs() const;
+    void showSummary(const BoardMetrics& metrics);
     
     void gameOverRevealMines(const GameBoardCoord& cause);
     void gameWonMarkMines();
@@ -25,6 +47,10 @@ private slots:
     void onMark(const GameBoardCoord& coord);
     void onReveal(const GameBoardCoord& coord);
     void onOptionsChanged(const GameSettings& settings);
+    void onBoardCode(const GameSettings& settings, const GameBoardCoord& anchor);
+    void onBoardPublished(const BoardUpdate& update);
+    void onRaceProgress(const RaceProgress& progress);
+    void onRaceFinished(const RaceProgress& standing);
 
     // these functions implement the feature where when you click a number to reveal and
     // before you lift your mouse button, the surrounding 8 squares flash blank. these are
@@ -35,9 +61,15 @@ private slots:
     void onTimerUpdated();
 
     void onActionAbout();
+    void onActionUndo();
+    void onActionRedo();
     void onActionBeginner();
     void onActionIntermediate();
     void onActionAdvanced();
+    void onActionCopyCode();
+    void onActionExportMines();
+    void onActionImportMines();
+    void onActionLeaderboard();
     void onActionOptions() const;
     void onActionGithub() const;
     void onActionTutorial() const;
@@ -48,9 +80,22 @@ private slots:
 private:
     GameSettings m_settings;
     GameState m_state;
-    GameBoard m_board;
+    GameBoard m_board; // gui-side copy of the worker's board, only used for rendering
     GameView* m_game_window = nullptr;
-    QTimer* m_timer = nullptr;
+    QTimer* m_timer = nullptr; // only refreshes the lcd
+    QElapsedTimer m_clock; // invalid while the game is not running
+    qint64 m_banked_ms = 0; // time from before the clock was last stopped
+    bool m_is_imported = false; // the mines came from a bitmap rather than the seed
+
+    BoardWorker* m_worker = nullptr;
+    QThread m_worker_thread;
+    ScriptDriver* m_driver = nullptr;
+    RaceClient* m_race = nullptr; // only while racing. the board then belongs to the race
+    Leaderboard m_leaderboard;
+    GameStatistics m_statistics; // of this session, nothing loads or saves it yet
+    QString m_data_path; // where the leaderboard and the saved game live
+    QTimer* m_save_timer = nullptr;
+    WinRateEstimator* m_estimator = nullptr; // only busy while the options are open
 
     const int32_t m_min_size = minScreenSize();
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <cstdint>
+
+#include "app/client.h"
+#include "model/code.h"
+#include "utils/config.h"
+
+RaceClient::RaceClient(QObject* parent) : QObject(parent) {
+    connect(&m_socket, &QTcpSocket::readyRead, this, &RaceClient::onReadyRead);
+    connect(&m_socket, &QTcpSocket::disconnected, this, &RaceClient::disconnected);
+    connect(&m_socket, &QTcpSocket::connected, this, [this] {
+        // moves are tiny and sent one at a time, so nagle would only add latency
+        m_socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    });
+    connect(&m_socket, &QTcpSocket::errorOccurred, this, [this] {
+        LOG_WARN("client: {}", m_socket.errorString().toStdString());
+    });
+}
+
+void RaceClient::connectTo(const QString& address) {
+    const qsizetype colon = address.lastIndexOf(':');
+    bool ok = false;
+    const quint16 port = address.mid(colon + 1).toUShort(&ok);
+    if (colon <= 0 || !ok) {
+        LOG_WARN("client: expected host:port, got {}", address.toStdString());
+        return;
+    }
+
+    m_socket.connectToHost(address.left(colon), port);
+}
+
+void RaceClient::send(RaceMove move, const GameBoardCoord& coord) {
+    if (isJoined())
+        m_socket.write(encodeRaceMove({ move, coord }));
+}
+
+bool RaceClient::isJoined() const {
+    return m_player != 0;
+}
+
+void RaceClient::onReadyRead() {
+    m_reader.append(m_socket.readAll());
+    RaceMessage type;
+    QByteArray payload;
+    while (m_reader.next(type, payload)) {
+        RaceWelcome welcome;
+        RaceProgress progress;
+        GameSettings settings;
+        GameBoardCoord anchor;
+        if (type == RaceMessage::Welcome && decodeRaceWelcome(payload, welcome) && decodeBoardCode(welcome.code, settings, anchor)) {
+            m_player = welcome.player;
+            LOG_INFO("client: joined race {} as player {}", welcome.code.toStdString(), m_player);
+            emit joined(settings, anchor);
+        } else if (type == RaceMessage::Progress && decodeRaceProgress(payload, progress)) {
+            emit progressed(progress);
+        } else if (type == RaceMessage::Standing && decodeRaceProgress(payload, progress)) {
+            emit finished(progress);
+        } else {
+            LOG_WARN("client: unexpected message from the server");
+            m_socket.abort();
+            return;
+        }
+    }
+
+    if (m_reader.failed()) {
+        LOG_WARN("client: malformed frame from the server");
+        m_socket.abort();
+    }
+}
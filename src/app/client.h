@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include <QObject>
+#include <QString>
+#include <QTcpSocket>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/protocol.h"
+
+// the player side of a race (see RaceServer). the local board is played as usual and
+// every reveal and mark is also sent to the server, which keeps the authoritative board
+// and decides the result and the finishing order
+class RaceClient : public QObject {
+    Q_OBJECT
+public:
+    explicit RaceClient(QObject* parent = nullptr);
+
+    // address is host:port
+    void connectTo(const QString& address);
+    void send(RaceMove move, const GameBoardCoord& coord);
+    bool isJoined() const;
+
+private:
+    void onReadyRead();
+
+signals:
+    // the board of the race, to be loaded with its anchor
+    void joined(const GameSettings& settings, const GameBoardCoord& anchor) const;
+    // the server's answer to one of our moves
+    void progressed(const RaceProgress& progress) const;
+    // another player finished
+    void finished(const RaceProgress& standing) const;
+    void disconnected() const;
+
+private:
+    QTcpSocket m_socket;
+    RaceFrameReader m_reader;
+    uint32_t m_player = 0; // 0 until welcomed
+};
@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <fmt/format.h>
+
+#include "app/driver.h"
+#include "app/app.h"
+#include "model/code.h"
+#include "utils/config.h"
+
+ScriptDriver::ScriptDriver(App& app, const QString& path, QObject* parent) : QObject(parent), m_app(app) {
+    bool is_open = false;
+    if (path == "-") {
+        is_open = m_file.open(stdin, QIODevice::ReadOnly | QIODevice::Text);
+    } else {
+        m_file.setFileName(path);
+        is_open = m_file.open(QIODevice::ReadOnly | QIODevice::Text);
+    }
+
+    if (!is_open) {
+        LOG_ERR("driver: could not open script {}", path.toStdString());
+        QMetaObject::invokeMethod(&m_app, [] { QCoreApplication::exit(1); }, Qt::QueuedConnection);
+        return;
+    }
+
+    // connected after the app, so the app has applied an update by the time it gets here
+    connect(m_app.m_worker, &BoardWorker::published, this, &ScriptDriver::onBoardPublished, Qt::QueuedConnection);
+    // a board from the command line is loaded before the first command. the worker may
+    // have published it before the connection above existed, and then the app's copy of
+    // the update is already queued ahead of the first command
+    m_waiting_for = m_app.m_worker->posted();
+    if (m_waiting_for <= m_app.m_worker->publishedSequence()) {
+        m_waiting_for = 0;
+        QMetaObject::invokeMethod(this, &ScriptDriver::next, Qt::QueuedConnection);
+    }
+}
+
+void ScriptDriver::next() {
+    // one command per event loop turn, so the view gets to render in between
+    while (!m_file.atEnd()) {
+        const QString line = QString::fromUtf8(m_file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        m_command = line.toStdString();
+        m_latency.start();
+        if (!run(line)) {
+            report(false);
+        } else if (m_waiting_for == 0) {
+            report(true);
+        }
+        return;
+    }
+
+    QCoreApplication::exit(0);
+}
+
+bool ScriptDriver::run(const QString& line) {
+    const QStringList args = line.split(' ', Qt::SkipEmptyParts);
+    const QString& command = args[0];
+    std::vector<int64_t> numbers; // wide enough for seeds
+    for (qsizetype i = 1; i < args.size(); i++) {
+        bool ok = false;
+        numbers.push_back(args[i].toLongLong(&ok));
+        if (!ok && command != "code")
+            return false;
+    }
+
+    GameBoardCoord coord = { -1, -1 };
+    if (numbers.size() == 2 && numbers[0] <= INT32_MAX && numbers[1] <= INT32_MAX)
+        coord = { int32_t(numbers[0]), int32_t(numbers[1]) };
+    const bool is_coord_valid = coord.row >= 0 && coord.col >= 0
+        && coord.row < m_app.m_board.rowSize() && coord.col < m_app.m_board.colSize();
+    const uint64_t posted = m_app.m_worker->posted();
+
+    if (command == "reveal" && is_coord_valid) {
+        m_app.onReveal(coord);
+    } else if (command == "mark" && is_coord_valid) {
+        m_app.onMark(coord);
+    } else if (command == "chord" && is_coord_valid) {
+        // what a mouse does: the preview on press, then the reveal on release
+        m_app.onRevealAltDown(coord);
+        m_app.onReveal(coord);
+    } else if (command == "undo" && args.size() == 1) {
+        m_app.onActionUndo();
+    } else if (command == "redo" && args.size() == 1) {
+        m_app.onActionRedo();
+    } else if (command == "restart" && args.size() == 1) {
+        m_app.onRestart();
+    } else if (command == "new" && (numbers.size() == 3 || numbers.size() == 4)) {
+        // the first move may need a 3x3 free area, so that much space is always kept
+        if (numbers[0] < 3 || numbers[1] < 3 || numbers[0] > 1000 || numbers[1] > 1000)
+            return false;
+        if (numbers[2] < 0 || numbers[2] > numbers[0] * numbers[1] - 9)
+            return false;
+        if (numbers.size() == 4 && (numbers[3] < 0 || numbers[3] > UINT32_MAX - 1))
+            return false;
+        m_app.m_settings.row_size = numbers[0];
+        m_app.m_settings.col_size = numbers[1];
+        m_app.m_settings.num_mines = numbers[2];
+        m_app.m_settings.is_set_seed = numbers.size() == 4;
+        if (m_app.m_settings.is_set_seed)
+            m_app.m_settings.seed = numbers[3];
+        m_app.onRestart();
+    } else if (command == "code" && args.size() == 2) {
+        GameSettings settings = m_app.m_settings;
+        GameBoardCoord anchor;
+        if (!decodeBoardCode(args[1], settings, anchor))
+            return false;
+        m_app.onBoardCode(settings, anchor);
+    } else if (command == "state" && args.size() == 1) {
+        // nothing to wait for
+    } else if (command == "quit" && args.size() == 1) {
+        m_file.close();
+    } else {
+        return false;
+    }
+
+    const uint64_t last = m_app.m_worker->posted();
+    m_waiting_for = (last != posted) ? last : 0;
+    return true;
+}
+
+void ScriptDriver::onBoardPublished(const BoardUpdate& update) {
+    // updates for actions that were not posted by a command (or that only contain part
+    // of a command, like the preview of a chord) are ignored. so are updates in the middle
+    // of an assist cascade, the command is done once the worker stops posting itself more
+    if (m_waiting_for == 0 || update.sequence < m_waiting_for || update.has_assist_work)
+        return;
+
+    m_waiting_for = 0;
+    if (m_command.empty()) {
+        QMetaObject::invokeMethod(this, &ScriptDriver::next, Qt::QueuedConnection);
+    } else {
+        report(true);
+    }
+}
+
+void ScriptDriver::report(bool ok) {
+    const GameState& state = m_app.m_state;
+    std::string escaped;
+    for (const char c : m_command) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (uint8_t(c) < 0x20) {
+            // json strings may not contain control characters, not even tabs
+            escaped += fmt::format("\\u{:04x}", int(c));
+        } else {
+            escaped += c;
+        }
+    }
+
+    fmt::print(
+        "{{\"command\": \"{}\", \"ok\": {}, \"latency_us\": {}, \"won\": {}, \"lost\": {}, "
+        "\"mines\": {}, \"clicks\": {}, \"timer_ms\": {}}}\n",
+        escaped, ok, m_latency.nsecsElapsed() / 1000, state.won, state.lost,
+        state.mines, state.clicks, state.timer
+    );
+    std::fflush(stdout);
+    QMetaObject::invokeMethod(this, &ScriptDriver::next, Qt::QueuedConnection);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include <QObject>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QString>
+
+#include "app/worker.h"
+
+class App;
+
+// drives an App from a line based script instead of mouse events, so that games can be
+// played end to end without a user (e.g. under QT_QPA_PLATFORM=offscreen in ci). every
+// command goes through the same App handlers that the view signals are connected to,
+// and the next command is only read once App has applied the update of the previous one.
+// every command prints one json line to stdout with its latency and the resulting state.
+//
+// commands (coordinates are zero based, lines starting with # are ignored):
+//   reveal <row> <col>         mark <row> <col>         chord <row> <col>
+//   undo                       redo                     restart
+//   new <rows> <cols> <mines> [seed]                    code <board code>
+//   state                      quit
+class ScriptDriver : public QObject {
+public:
+    // path "-" reads from stdin
+    ScriptDriver(App& app, const QString& path, QObject* parent = nullptr);
+
+private:
+    void next();
+    // returns false for an unknown or malformed command
+    bool run(const QString& line);
+    void onBoardPublished(const BoardUpdate& update);
+    void report(bool ok);
+
+private:
+    App& m_app;
+    QFile m_file;
+    QElapsedTimer m_latency;
+    std::string m_command = {};
+    uint64_t m_waiting_for = 0; // sequence of the last posted action, 0 if not waiting
+};
@@ -0,0 +1,85 @@
+#include <random>
+#include <cstdint>
+#include <algorithm>
+
+#include <QThread>
+#include <QMetaObject>
+
+#include "app/estimator.h"
+#include "model/board.h"
+#include "model/feasibility.h"
+#include "model/random.h"
+#include "model/solver.h"
+
+WinRateEstimator::WinRateEstimator(QObject* parent) : QObject(parent) {
+    // one core is left to the gui and the board worker, and the games run below them
+    m_pool.setMaxThreadCount(std::max(QThread::idealThreadCount() - 1, 1));
+    m_pool.setThreadPriority(QThread::LowPriority);
+}
+
+WinRateEstimator::~WinRateEstimator() {
+    cancel();
+    m_pool.waitForDone();
+}
+
+void WinRateEstimator::start(const GameSettings& settings) {
+    cancel();
+    m_settings = settings;
+    m_settings.generator = GameGenerator::Xoshiro; // cheaper to seed for every game
+    m_settings.is_auto_chord = false;
+    m_settings.is_auto_flag = false;
+    m_key = mixBits(std::random_device()());
+    m_next_chunk = 0;
+    m_estimate = WinRateEstimate();
+
+    // every first click is at the centre, like in the race and the corpus tool
+    const GameBoardCoord anchor = { m_settings.row_size / 2, m_settings.col_size / 2 };
+    m_estimate.is_done = !isFeasible(m_settings, anchor);
+    emit estimated(m_estimate);
+    if (m_estimate.is_done)
+        return;
+
+    // two chunks per thread keep every thread busy between the results
+    for (int32_t i = 0; i < 2 * m_pool.maxThreadCount(); i++)
+        queueChunk();
+}
+
+void WinRateEstimator::cancel() {
+    m_generation++;
+    m_pool.clear();
+}
+
+void WinRateEstimator::queueChunk() {
+    const uint64_t generation = m_generation;
+    const uint64_t first_game = m_next_chunk++ * s_chunk_games;
+    m_pool.start([this, generation, first_game, settings = m_settings, key = m_key]() mutable {
+        const GameBoardCoord anchor = { settings.row_size / 2, settings.col_size / 2 };
+        GameBoard board(settings);
+        int64_t games = 0, wins = 0;
+        for (int32_t i = 0; i < s_chunk_games && m_generation == generation; i++) {
+            const uint64_t random = counterRandom(key, first_game + i);
+            settings.seed = uint32_t(random);
+            wins += solveGame(board, settings, anchor, random >> 32);
+            games++;
+        }
+        // results of a cancelled estimate are dropped by onChunkDone, and results that
+        // arrive after the estimator is gone are dropped with it
+        QMetaObject::invokeMethod(this, [this, generation, games, wins] {
+            onChunkDone(generation, games, wins);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void WinRateEstimator::onChunkDone(uint64_t generation, int64_t games, int64_t wins) {
+    if (generation != m_generation || m_estimate.is_done)
+        return;
+
+    m_estimate = estimateWinRate(m_estimate.games + games, m_estimate.wins + wins);
+    m_estimate.is_done = m_estimate.games >= s_max_games || m_estimate.upper - m_estimate.lower <= s_target_width;
+
+    if (m_estimate.is_done)
+        cancel(); // the chunks still running add nothing that is needed
+    else
+        queueChunk();
+    emit estimated(m_estimate);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <QObject>
+#include <QThreadPool>
+
+#include "model/data.h"
+#include "model/solver.h"
+
+// estimates how often a configuration is won by playing random boards of it with the
+// solver (see model/solver.h) on a thread pool. the estimate is published after every
+// chunk of games, so the interval narrows while it runs. only a few chunks are queued at a
+// time, and starting a new estimate cancels the old one: its queued chunks are dropped and
+// its running chunks stop after their current game, so the pool is free again almost at once
+class WinRateEstimator : public QObject {
+    Q_OBJECT
+public:
+    explicit WinRateEstimator(QObject* parent = nullptr);
+    ~WinRateEstimator();
+
+public slots:
+    // the size, the mine count and the first move policy of settings are estimated
+    void start(const GameSettings& settings);
+    void cancel();
+
+signals:
+    void estimated(const WinRateEstimate& estimate) const;
+
+private:
+    void queueChunk();
+    void onChunkDone(uint64_t generation, int64_t games, int64_t wins);
+
+private:
+    static constexpr int32_t s_chunk_games = 32;
+    static constexpr int64_t s_max_games = 20000;
+    static constexpr double s_target_width = 0.02; // upper - lower, so about +-1%
+
+    QThreadPool m_pool;
+    std::atomic<uint64_t> m_generation = 0; // bumped by every start and cancel
+    GameSettings m_settings;
+    uint64_t m_key = 0; // seeds the boards of the current estimate
+    uint64_t m_next_chunk = 0;
+    WinRateEstimate m_estimate;
+};
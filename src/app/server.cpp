@@ -0,0 +1,176 @@
+#include <memory>
+#include <cstdint>
+
+#include "app/server.h"
+#include "model/code.h"
+#include "utils/config.h"
+
+RaceServer::RaceServer(const GameSettings& settings, QObject* parent) : QObject(parent), m_settings(settings) {
+    // the usual opening click. the mines are placed once for every player, so unlike in a
+    // normal game only this square is known to be safe: a first reveal anywhere else can
+    // hit a mine. the anchor is part of the code in every welcome, for clients to open first
+    m_anchor = { m_settings.row_size / 2, m_settings.col_size / 2 };
+    // the code and the moves carry rows and columns in a byte, so larger boards are not
+    // even allocated. without mines there is no race, and an empty code makes listen fail
+    if (!isRaceSize())
+        return;
+    m_board = GameBoard(m_settings);
+    if (m_board.preloadMines(m_anchor))
+        m_code = encodeBoardCode(m_settings, m_anchor);
+    connect(&m_server, &QTcpServer::newConnection, this, &RaceServer::onNewConnection);
+}
+
+bool RaceServer::isRaceSize() const {
+    return m_settings.row_size > 0 && m_settings.row_size <= s_max_size
+        && m_settings.col_size > 0 && m_settings.col_size <= s_max_size;
+}
+
+bool RaceServer::listen(const QHostAddress& address, quint16 port) {
+    if (!isRaceSize()) {
+        LOG_ERR("server: a {}x{} board cannot be raced, rows and columns go from 1 to {}", m_settings.row_size, m_settings.col_size, s_max_size);
+        return false;
+    }
+    if (m_code.isEmpty()) {
+        LOG_ERR("server: {} mines do not fit a {}x{} board", m_settings.num_mines, m_settings.row_size, m_settings.col_size);
+        return false;
+    }
+    if (!m_server.listen(address, port)) {
+        LOG_ERR("server: could not listen on port {}: {}", port, m_server.errorString().toStdString());
+        return false;
+    }
+
+    LOG_INFO("server: race {} on port {}", m_code.toStdString(), m_server.serverPort());
+    return true;
+}
+
+void RaceServer::setSpectators(SpectatorHub* hub) {
+    m_spectators = hub;
+}
+
+quint16 RaceServer::port() const {
+    return m_server.serverPort();
+}
+
+int32_t RaceServer::players() const {
+    return m_players.size();
+}
+
+uint64_t RaceServer::moves() const {
+    return m_moves;
+}
+
+void RaceServer::onNewConnection() {
+    while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+        auto player = std::make_unique<Player>();
+        player->id = m_next_id++;
+        player->socket = socket;
+        player->board = m_board;
+        player->state.mines = m_settings.num_mines;
+        // moves are tiny and answered one by one, so nagle would only add latency
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        // the handlers look the player up by id, since the player is gone once it disconnects
+        const uint32_t id = player->id;
+        if (m_spectators)
+            m_spectators->publish(id, player->board, player->state, {});
+        m_players.emplace(id, std::move(player));
+        connect(socket, &QTcpSocket::readyRead, this, [this, id] { onReadyRead(id); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, id] { onDisconnected(id); });
+        socket->write(encodeRaceWelcome({ id, m_code }));
+    }
+}
+
+void RaceServer::onReadyRead(uint32_t id) {
+    const auto it = m_players.find(id);
+    if (it == m_players.end())
+        return;
+    Player& player = *it->second;
+    player.reader.append(player.socket->readAll());
+
+    // every pending move is answered, and the answers go out in one write
+    QByteArray replies;
+    RaceMessage type;
+    QByteArray payload;
+    while (player.reader.next(type, payload)) {
+        RaceMoveMessage move;
+        if (type != RaceMessage::Move || !decodeRaceMove(payload, move)) {
+            LOG_WARN("server: dropping player {} after an unexpected message", player.id);
+            player.socket->abort();
+            return;
+        }
+
+        const bool was_won = player.state.won;
+        const RaceProgress progress = apply(player, move);
+        replies.append(encodeRaceProgress(RaceMessage::Progress, progress));
+        if (!was_won && player.state.won) {
+            // a finish is the only thing everyone hears about
+            const QByteArray standing = encodeRaceProgress(RaceMessage::Standing, progress);
+            for (const auto& [other_id, other] : m_players) {
+                if (other_id != player.id)
+                    other->socket->write(standing);
+            }
+        }
+    }
+
+    if (player.reader.failed()) {
+        LOG_WARN("server: dropping player {} after a malformed frame", player.id);
+        player.socket->abort();
+        return;
+    }
+
+    if (!replies.isEmpty())
+        player.socket->write(replies);
+}
+
+void RaceServer::onDisconnected(uint32_t id) {
+    // the socket may still be in the middle of emitting, so it is deleted later
+    const auto it = m_players.find(id);
+    if (it == m_players.end())
+        return;
+    it->second->socket->deleteLater();
+    m_players.erase(it);
+    if (m_spectators)
+        m_spectators->remove(id);
+}
+
+RaceProgress RaceServer::apply(Player& player, const RaceMoveMessage& move) {
+    m_moves++;
+    const GameBoardCoord& coord = move.coord;
+    const bool is_valid = coord.row < m_settings.row_size && coord.col < m_settings.col_size
+        && !player.state.won && !player.state.lost;
+    if (!is_valid) {
+        RaceProgress progress = progressOf(player);
+        progress.rejected = true;
+        return progress;
+    }
+
+    if (!player.clock.isValid())
+        player.clock.start();
+    if (move.move == RaceMove::Reveal) {
+        player.board.reveal(coord, player.state);
+    } else {
+        player.board.mark(coord, player.state);
+    }
+
+    // the changes are not sent to the player, who applies the same move to the same board
+    if (m_spectators)
+        m_spectators->publish(player.id, player.board, player.state, player.board.changedSquares());
+    player.board.clearChangedSquares();
+    if (player.state.won || player.state.lost)
+        player.state.timer = player.clock.elapsed();
+    if (player.state.won)
+        player.rank = ++m_winners;
+    return progressOf(player);
+}
+
+RaceProgress RaceServer::progressOf(const Player& player) const {
+    RaceProgress progress;
+    progress.player = player.id;
+    progress.won = player.state.won;
+    progress.lost = player.state.lost;
+    progress.mines = player.state.mines;
+    progress.clicks = player.state.clicks;
+    progress.rank = player.rank;
+    progress.time_ms = (player.state.won || player.state.lost) ? player.state.timer : 0;
+    return progress;
+}
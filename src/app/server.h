@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/protocol.h"
+#include "app/spectator.h"
+
+// hosts one race: every player that connects gets its own authoritative copy of the same
+// board, with the mines placed around a fixed anchor so that all copies are identical.
+// clients only send moves, the server applies and validates them and answers each with
+// the resulting progress. the sockets are served from the thread's event loop, so one
+// server handles thousands of players without a thread per connection
+class RaceServer : public QObject {
+public:
+    explicit RaceServer(const GameSettings& settings, QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address, quint16 port);
+    // every player's board is streamed to the hub, if there is one
+    void setSpectators(SpectatorHub* hub);
+    quint16 port() const;
+    int32_t players() const;
+    uint64_t moves() const; // moves applied since the server started, valid or not
+
+private:
+    struct Player {
+        uint32_t id = 0;
+        QTcpSocket* socket = nullptr;
+        RaceFrameReader reader;
+        GameBoard board;
+        GameState state;
+        QElapsedTimer clock; // started by the first move
+        int32_t rank = 0;
+    };
+
+    void onNewConnection();
+    void onReadyRead(uint32_t id);
+    void onDisconnected(uint32_t id);
+    RaceProgress apply(Player& player, const RaceMoveMessage& move);
+    RaceProgress progressOf(const Player& player) const;
+    bool isRaceSize() const;
+
+private:
+    static constexpr int32_t s_max_size = 255; // rows and columns are sent as one byte
+
+    QTcpServer m_server;
+    SpectatorHub* m_spectators = nullptr;
+    GameSettings m_settings;
+    GameBoardCoord m_anchor = { 0, 0 };
+    GameBoard m_board; // copied for every player, so the mines are only placed once
+    QString m_code = QString(); // board code of the race, sent in every welcome
+    std::unordered_map<uint32_t, std::unique_ptr<Player>> m_players = {};
+    uint32_t m_next_id = 1;
+    int32_t m_winners = 0;
+    uint64_t m_moves = 0;
+};
@@ -0,0 +1,123 @@
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "app/spectator.h"
+#include "utils/config.h"
+
+namespace {
+
+    // late joiners get keyframes anyway, this bounds how far a broken copy can drift
+    constexpr int32_t s_keyframe_interval = 64;
+    // a subscriber that falls this far behind is dropped rather than buffered for
+    constexpr qint64 s_max_backlog = 8 * 1024 * 1024;
+
+}
+
+SpectatorHub::SpectatorHub(QObject* parent) : QObject(parent) {
+    connect(&m_server, &QLocalServer::newConnection, this, &SpectatorHub::onNewConnection);
+}
+
+bool SpectatorHub::listen(const QString& name) {
+    QLocalServer::removeServer(name); // left behind if a previous server crashed
+    if (!m_server.listen(name)) {
+        LOG_ERR("spectator: could not listen on {}: {}", name.toStdString(), m_server.errorString().toStdString());
+        return false;
+    }
+
+    LOG_INFO("spectator: streaming on {}", m_server.fullServerName().toStdString());
+    return true;
+}
+
+int32_t SpectatorHub::subscribers() const {
+    return m_subscribers.size();
+}
+
+void SpectatorHub::publish(uint32_t id, const GameBoard& board, const GameState& state, const std::vector<GameBoardCoord>& changed) {
+    auto [it, is_new] = m_streams.try_emplace(id);
+    Stream& stream = it->second;
+    SpectatorBoard& copy = stream.board;
+    const int32_t cols = board.colSize();
+    if (is_new || copy.row_size != board.rowSize() || copy.col_size != cols) {
+        copy.row_size = board.rowSize();
+        copy.col_size = cols;
+        copy.tiles.resize(copy.row_size * cols);
+        for (int32_t i = 0; i < copy.row_size; i++) {
+            for (int32_t j = 0; j < cols; j++)
+                copy.tiles[i * cols + j] = boardTile(board.getSquare({ i, j }));
+        }
+        stream.since_keyframe = s_keyframe_interval; // forces a keyframe below
+    }
+
+    // the copy is kept up to date even without subscribers, so a new one can be sent a
+    // keyframe right away. a square listed twice is only different the first time
+    m_changes.clear();
+    for (const GameBoardCoord& coord : changed) {
+        const int32_t square = coord.row * cols + coord.col;
+        const uint8_t tile = boardTile(board.getSquare(coord));
+        if (copy.tiles[square] != tile) {
+            copy.tiles[square] = tile;
+            m_changes.push_back({ square, tile });
+        }
+    }
+
+    const bool is_keyframe = stream.since_keyframe >= s_keyframe_interval;
+    if (m_changes.empty() && !is_keyframe && copy.won == state.won && copy.lost == state.lost && copy.mines == state.mines)
+        return;
+
+    copy.sequence++;
+    copy.won = state.won;
+    copy.lost = state.lost;
+    copy.mines = state.mines;
+    stream.since_keyframe = is_keyframe ? 0 : stream.since_keyframe + 1;
+    if (m_subscribers.empty())
+        return;
+
+    if (is_keyframe) {
+        broadcast(encodeSpectatorKeyframe(id, copy));
+    } else {
+        std::sort(m_changes.begin(), m_changes.end(), [](const SpectatorChange& a, const SpectatorChange& b) {
+            return a.square < b.square;
+        });
+        broadcast(encodeSpectatorDelta(id, copy, m_changes));
+    }
+}
+
+void SpectatorHub::remove(uint32_t id) {
+    m_streams.erase(id);
+}
+
+void SpectatorHub::onNewConnection() {
+    while (QLocalSocket* socket = m_server.nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket] { onDisconnected(socket); });
+        m_subscribers.push_back(socket);
+        for (const auto& [id, stream] : m_streams)
+            socket->write(encodeSpectatorKeyframe(id, stream.board));
+    }
+}
+
+void SpectatorHub::onDisconnected(QLocalSocket* socket) {
+    const auto it = std::find(m_subscribers.begin(), m_subscribers.end(), socket);
+    if (it != m_subscribers.end())
+        m_subscribers.erase(it);
+    socket->deleteLater();
+}
+
+void SpectatorHub::broadcast(const QByteArray& frame) {
+    // the sockets share the frame's buffer instead of copying it
+    std::vector<QLocalSocket*> dropped;
+    for (QLocalSocket* socket : m_subscribers) {
+        if (socket->bytesToWrite() > s_max_backlog) {
+            dropped.push_back(socket);
+            continue;
+        }
+        socket->write(frame);
+    }
+
+    for (QLocalSocket* socket : dropped) {
+        LOG_WARN("spectator: dropping a subscriber that stopped reading");
+        std::erase(m_subscribers, socket);
+        socket->abort();
+        socket->deleteLater();
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/delta.h"
+
+// streams live boards to spectators on the same machine over a local socket. each board
+// is sent as a keyframe once and then only as the squares that every action changed (see
+// model/delta.h), with a fresh keyframe every so often. a frame is encoded once and the
+// same implicitly shared buffer is queued on every subscriber, so the cost per spectator
+// is a socket write rather than an encode
+class SpectatorHub : public QObject {
+public:
+    explicit SpectatorHub(QObject* parent = nullptr);
+
+    bool listen(const QString& name);
+    int32_t subscribers() const;
+
+    // reads the squares listed as changed (see GameBoard::changedSquares); squares that
+    // look the same as before are not sent
+    void publish(uint32_t id, const GameBoard& board, const GameState& state, const std::vector<GameBoardCoord>& changed);
+    void remove(uint32_t id);
+
+private:
+    struct Stream {
+        SpectatorBoard board;
+        int32_t since_keyframe = 0;
+    };
+
+    void onNewConnection();
+    void onDisconnected(QLocalSocket* socket);
+    void broadcast(const QByteArray& frame);
+
+private:
+    QLocalServer m_server;
+    std::vector<QLocalSocket*> m_subscribers = {};
+    std::unordered_map<uint32_t, Stream> m_streams = {};
+    std::vector<SpectatorChange> m_changes = {}; // reused between publishes
+};
@@ -0,0 +1,224 @@
+#include <mutex>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+#include <QFile>
+#include <QObject>
+#include <QMetaType>
+#include <QSaveFile>
+
+#include "app/worker.h"
+#include "model/feasibility.h"
+#include "model/snapshot.h"
+#include "utils/config.h"
+
+BoardWorker::BoardWorker(const GameSettings& settings, QObject* parent) : QObject(parent) {
+    qRegisterMetaType<BoardUpdate>();
+    m_settings = settings;
+    m_state = GameState();
+    m_state.mines = m_settings.num_mines;
+    m_state.timer = 0;
+    m_board = GameBoard(m_settings);
+}
+
+uint64_t BoardWorker::post(const BoardAction& action) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(action);
+    if (!m_scheduled) {
+        // one drain is enough for everything that is queued until it starts running
+        m_scheduled = true;
+        QMetaObject::invokeMethod(this, &BoardWorker::drain, Qt::QueuedConnection);
+    }
+
+    return ++m_posted;
+}
+
+uint64_t BoardWorker::posted() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_posted;
+}
+
+uint64_t BoardWorker::publishedSequence() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_published;
+}
+
+void BoardWorker::save(const QString& path, int64_t timer_ms, bool is_imported, bool wait) {
+    // queued behind the drain of everything posted so far, so the save includes it
+    QMetaObject::invokeMethod(this, [this, path, timer_ms, is_imported, wait] {
+        saveImpl(path, timer_ms, is_imported, wait);
+    }, wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+}
+
+void BoardWorker::saveImpl(const QString& path, int64_t timer_ms, bool is_imported, bool is_final) {
+    if (m_state.is_first_reveal || m_state.won || m_state.lost) {
+        if (QFile::exists(path) && !QFile::remove(path))
+            LOG_WARN("worker: could not remove the saved game {}", path.toStdString());
+        m_saved_timer = -1;
+        return;
+    }
+
+    // the clock runs while the player thinks, so the time alone would make every periodic
+    // save a write. they are skipped until an action reaches the board, and only the final
+    // save brings the time up to date
+    if (m_drained == m_saved_drained && (!is_final || timer_ms == m_saved_timer))
+        return;
+
+    GameSnapshot snapshot;
+    snapshot.settings = m_settings;
+    snapshot.state = m_state;
+    snapshot.state.revealing_mine = false;
+    snapshot.state.timer = timer_ms;
+    snapshot.is_imported = is_imported;
+    snapshot.mines = m_board.mineBitmap();
+    snapshot.visible = m_board.visibleBitmap();
+
+    // written to a temporary file and renamed, so a crash never leaves half a save
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(encodeGameSnapshot(snapshot)) < 0 || !file.commit()) {
+        LOG_WARN("worker: could not save the game to {}", path.toStdString());
+        return;
+    }
+
+    m_saved_drained = m_drained;
+    m_saved_timer = timer_ms;
+    LOG_DEBUG("worker: saved the game at {} ms", timer_ms);
+}
+
+void BoardWorker::drain() {
+    m_batch.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(m_batch, m_queue);
+        m_scheduled = false;
+    }
+
+    // counted before coalescing, since dropped actions are handled too
+    m_drained += m_batch.size();
+
+    coalesce(m_batch);
+    if (m_batch.empty())
+        return;
+
+    BoardUpdate update;
+    update.sequence = m_drained;
+    m_board.clearChangedSquares();
+    for (const BoardAction& action : m_batch)
+        apply(action, update);
+
+    const std::vector<GameBoardCoord>& changed = m_board.changedSquares();
+    update.changes.reserve(changed.size());
+    for (const GameBoardCoord& coord : changed)
+        update.changes.push_back({ coord, m_board.getSquare(coord) });
+    update.state = m_state;
+    update.has_assist_work = m_board.hasAssistWork();
+    if (m_state.won || m_state.lost)
+        update.metrics = measureBoard(m_board);
+    m_board.clearChangedSquares();
+
+    LOG_DEBUG("worker: applied {} action(s), {} square(s) changed", m_batch.size(), update.changes.size());
+    emit published(update);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_published = update.sequence;
+    }
+
+    // the rest of the assist work is done in later batches, so that the gui gets to
+    // show each step and a move posted meanwhile is not held up behind all of it
+    if (update.has_assist_work)
+        post({ BoardActionType::Assist });
+}
+
+void BoardWorker::apply(const BoardAction& action, BoardUpdate& update) {
+    // see coalesce(); any action that lifts the chord preview also ends the revealing face
+    if (action.type != BoardActionType::PreviewDown && action.type != BoardActionType::UpdateSettings)
+        m_state.revealing_mine = false;
+
+    switch (action.type) {
+    case BoardActionType::Reveal:
+        m_board.reveal(action.coord, m_state);
+        break;
+    case BoardActionType::Mark:
+        m_board.mark(action.coord, m_state);
+        break;
+    case BoardActionType::PreviewDown:
+        m_state.revealing_mine = true;
+        m_board.revealAdjacentDown(action.coord);
+        break;
+    case BoardActionType::PreviewUp:
+        m_board.revealAdjacentUp();
+        break;
+    case BoardActionType::Undo:
+        m_board.undo(m_state);
+        break;
+    case BoardActionType::Redo:
+        m_board.redo(m_state);
+        break;
+    case BoardActionType::Assist:
+        m_board.assist(m_state);
+        break;
+    case BoardActionType::Reset:
+        m_settings = action.settings;
+        m_board.reset(m_settings);
+        m_state = GameState();
+        m_state.mines = m_settings.num_mines;
+        m_state.timer = 0;
+        if (!action.mines.empty()) {
+            if (!m_board.preloadMines(action.mines))
+                LOG_WARN("worker: mine bitmap does not fit a {}x{} board", m_settings.row_size, m_settings.col_size);
+        } else if (action.anchor.row >= 0) {
+            if (!m_board.preloadMines(action.anchor))
+                LOG_WARN("worker: {} mines do not fit a {}x{} board", m_settings.num_mines, m_settings.row_size, m_settings.col_size);
+            m_state.first_row = action.anchor.row;
+            m_state.first_col = action.anchor.col;
+        } else if (!checkFeasibility(m_settings).is_feasible) {
+            // the first reveal generates nothing where the mines do not fit around it
+            LOG_WARN("worker: {} mines do not fit every first move of a {}x{} board", m_settings.num_mines, m_settings.row_size, m_settings.col_size);
+        }
+        update.is_reset = true;
+        update.settings = m_settings;
+        break;
+    case BoardActionType::Resume:
+        m_settings = action.settings;
+        m_board.reset(m_settings);
+        m_state = action.state;
+        if (!m_board.restore(action.mines, action.visible)) {
+            LOG_WARN("worker: saved game does not fit a {}x{} board", m_settings.row_size, m_settings.col_size);
+            m_board.reset(m_settings);
+            m_state = GameState();
+            m_state.mines = m_settings.num_mines;
+            m_state.timer = 0;
+        }
+        update.is_reset = true;
+        update.settings = m_settings;
+        break;
+    case BoardActionType::UpdateSettings:
+        m_settings = action.settings;
+        m_board.updateSettings(m_settings);
+        break;
+    }
+}
+
+void BoardWorker::coalesce(std::vector<BoardAction>& actions) {
+    // a reset (or a resume) wipes the board and its history, so nothing queued before it matters
+    const auto last_reset = std::find_if(actions.rbegin(), actions.rend(), [](const BoardAction& action) {
+        return action.type == BoardActionType::Reset || action.type == BoardActionType::Resume;
+    });
+
+    if (last_reset != actions.rend())
+        actions.erase(actions.begin(), std::prev(last_reset.base()));
+
+    // every action except a settings update starts by lifting the current chord preview,
+    // so a preview down/up is only ever visible if it is the last thing in the batch
+    bool superseded = false;
+    for (int32_t i = actions.size() - 1; i >= 0; i--) {
+        const BoardActionType type = actions[i].type;
+        const bool is_preview = type == BoardActionType::PreviewDown || type == BoardActionType::PreviewUp;
+        if (is_preview && superseded) {
+            actions.erase(actions.begin() + i);
+        } else if (type != BoardActionType::UpdateSettings) {
+            superseded = true;
+        }
+    }
+}
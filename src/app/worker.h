@@ -0,0 +1,100 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+#include <QObject>
+#include <QString>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/analysis.h"
+
+enum class BoardActionType {
+    Reveal,
+    Mark,
+    PreviewDown,
+    PreviewUp,
+    Undo,
+    Redo,
+    Assist, // posted by the worker itself while the assists have work left
+    Reset,
+    Resume,
+    UpdateSettings
+};
+
+struct BoardAction {
+    BoardActionType type;
+    GameBoardCoord coord = { 0, 0 };
+    GameSettings settings = GameSettings(); // only used by reset and settings updates
+    // only used by reset: mines to load right away, either generated around the anchor
+    // (if its row is not negative) or copied from a mine bitmap (if not empty)
+    GameBoardCoord anchor = { -1, -1 };
+    std::vector<uint8_t> mines = {};
+    // only used by resume, which loads a saved game (see model/snapshot.h) with the mines
+    // above, the settings and this state
+    GameState state = GameState();
+    std::vector<uint8_t> visible = {};
+};
+
+// everything the gui thread needs to bring its copy of the board up to date after one
+// batch of actions. the update is immutable once published
+struct BoardUpdate {
+    bool is_reset = false;
+    GameSettings settings = GameSettings(); // the settings of the board after a reset
+    GameState state = GameState();
+    std::vector<GameBoardChange> changes = {}; // new values of every changed square
+    BoardMetrics metrics = BoardMetrics(); // only filled in once the game has ended
+    uint64_t sequence = 0; // number of actions posted up to the last one in this update
+    bool has_assist_work = false; // the worker posts itself an Assist to continue the moves
+};
+
+// owns the authoritative game board and game state, and applies actions to them on the
+// thread it lives on. actions are queued from the gui thread with post(), and all actions
+// that piled up while the worker was busy are applied together and published as a single
+// update, so slow operations on large boards never block the event loop.
+class BoardWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit BoardWorker(const GameSettings& settings, QObject* parent = nullptr);
+
+    // thread safe. returns the sequence number of the action: the update that includes
+    // it is the first with a sequence at least as large
+    uint64_t post(const BoardAction& action);
+    // thread safe. the sequence number of the last posted action
+    uint64_t posted();
+    // thread safe. the sequence of the last published update. it is only raised once the
+    // update has been emitted, so queued receivers already have it in their event queue
+    uint64_t publishedSequence();
+    // thread safe. saves the game to path on the worker thread, with the time played so
+    // far, or removes the file if no game is in progress. if wait is set, returns once the
+    // file is written. only a save with wait set rewrites a board that has not changed
+    void save(const QString& path, int64_t timer_ms, bool is_imported, bool wait = false);
+
+private:
+    void drain();
+    void saveImpl(const QString& path, int64_t timer_ms, bool is_imported, bool is_final);
+    void apply(const BoardAction& action, BoardUpdate& update);
+
+    // drops actions whose effects are overwritten by a later action of the same batch,
+    // e.g. chord preview down/up pairs or anything before a reset
+    static void coalesce(std::vector<BoardAction>& actions);
+
+signals:
+    void published(const BoardUpdate& update) const;
+
+private:
+    std::mutex m_mutex;
+    std::vector<BoardAction> m_queue = {};
+    std::vector<BoardAction> m_batch = {};
+    bool m_scheduled = false;
+    uint64_t m_posted = 0, m_drained = 0;
+    uint64_t m_published = 0; // guarded by m_mutex, unlike m_drained
+    uint64_t m_saved_drained = 0; // what the last save included, so idle saves are skipped
+    int64_t m_saved_timer = -1;
+
+    GameSettings m_settings;
+    GameState m_state;
+    GameBoard m_board;
+};
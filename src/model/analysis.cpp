@@ -0,0 +1,96 @@
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "model/analysis.h"
+
+namespace {
+
+    constexpr int32_t dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    constexpr int32_t dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+    void finish(BoardMetrics& metrics, int32_t safe_squares) {
+        metrics.bbbv = metrics.openings + metrics.isolated;
+        metrics.difficulty = safe_squares ? double(metrics.bbbv + metrics.isolated) / safe_squares : 0;
+    }
+
+}
+
+BoardMetrics measureBoard(const GameBoard& board) {
+    BoardMetrics metrics;
+    metrics.openings = board.regionCount();
+
+    int32_t safe_squares = 0;
+    for (int32_t i = 0; i < board.rowSize(); i++) {
+        for (int32_t j = 0; j < board.colSize(); j++) {
+            if (board.getSquare({ i, j }).is_mine)
+                continue;
+            safe_squares++;
+            metrics.isolated += !board.isOpenedByRegion({ i, j });
+        }
+    }
+
+    finish(metrics, safe_squares);
+    return metrics;
+}
+
+void measureBatch(const GameBatch& batch, std::vector<BoardMetrics>& metrics) {
+    const int32_t rows = batch.rowSize();
+    const int32_t cols = batch.colSize();
+    constexpr uint8_t mine = 0, zero = 1, number = 2;
+    std::vector<uint8_t> kind(rows * cols);
+    std::vector<uint8_t> opened(rows * cols);
+    std::vector<GameBoardCoord> stack;
+
+    // the squares of one board are spread out over the batch, so each board is first
+    // gathered into a compact array with one read per square. a batch keeps no region
+    // labels, so the openings are then found with a flood fill
+    metrics.assign(batch.size(), BoardMetrics());
+    for (int32_t b = 0; b < batch.size(); b++) {
+        int32_t safe_squares = 0;
+        for (int32_t i = 0; i < rows; i++) {
+            for (int32_t j = 0; j < cols; j++) {
+                const bool is_mine = batch.isMine(b, { i, j });
+                kind[i * cols + j] = is_mine ? mine : (batch.adjacentMines(b, { i, j }) ? number : zero);
+                safe_squares += !is_mine;
+            }
+        }
+
+        std::fill(opened.begin(), opened.end(), 0);
+        for (int32_t i = 0; i < rows; i++) {
+            for (int32_t j = 0; j < cols; j++) {
+                if (opened[i * cols + j] || kind[i * cols + j] != zero)
+                    continue;
+
+                metrics[b].openings++;
+                opened[i * cols + j] = 1;
+                stack.push_back({ i, j });
+                while (!stack.empty()) {
+                    const GameBoardCoord curr = stack.back();
+                    stack.pop_back();
+                    if (kind[curr.row * cols + curr.col] != zero)
+                        continue;
+                    for (int32_t k = 0; k < 8; k++) {
+                        const int32_t row = curr.row + dir_row[k];
+                        const int32_t col = curr.col + dir_col[k];
+                        if (row < 0 || row >= rows || col < 0 || col >= cols || opened[row * cols + col])
+                            continue;
+                        opened[row * cols + col] = 1;
+                        stack.push_back({ row, col });
+                    }
+                }
+            }
+        }
+
+        for (int32_t i = 0; i < rows * cols; i++)
+            metrics[b].isolated += kind[i] == number && !opened[i];
+        finish(metrics[b], safe_squares);
+    }
+}
+
+GameEfficiency measureEfficiency(const BoardMetrics& metrics, const GameState& state) {
+    GameEfficiency efficiency;
+    efficiency.bbbv_per_second = metrics.bbbv / (std::max<int64_t>(state.timer, 1) / 1000.0);
+    efficiency.clicks_per_bbbv = metrics.bbbv ? double(state.clicks) / metrics.bbbv : 0;
+    return efficiency;
+}
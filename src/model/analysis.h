@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/batch.h"
+
+// properties of a mine layout that do not depend on how the game is played
+struct BoardMetrics {
+    int32_t bbbv = 0; // 3bv: the fewest left clicks that clear the board
+    int32_t openings = 0; // connected regions of squares without adjacent mines
+    int32_t isolated = 0; // safe squares that no opening reveals, each needs its own click
+    // a rough estimate of how hard the layout is: the clicks a perfect player needs per
+    // safe square, with isolated squares counted twice since that is where guesses happen
+    double difficulty = 0;
+};
+
+// how well a finished game was played, compared to the metrics of its layout
+struct GameEfficiency {
+    double bbbv_per_second = 0;
+    double clicks_per_bbbv = 0;
+};
+
+// one pass over the squares, using the zero-region labels of the board (so the mines have
+// to be generated). only reads the mines and the adjacent counts, so the board may be in
+// any state of play
+BoardMetrics measureBoard(const GameBoard& board);
+// the metrics of every board of a batch, with metrics[i] for board i. the scratch space is
+// shared between the boards
+void measureBatch(const GameBatch& batch, std::vector<BoardMetrics>& metrics);
+
+GameEfficiency measureEfficiency(const BoardMetrics& metrics, const GameState& state);
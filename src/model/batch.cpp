@@ -0,0 +1,201 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include "model/batch.h"
+#include "model/feasibility.h"
+#include "model/random.h"
+
+namespace {
+
+    constexpr int32_t dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    constexpr int32_t dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+}
+
+GameBatch::GameBatch(const GameSettings& settings, int32_t count) : m_settings(settings), m_count(count) {
+    m_stride = m_settings.col_size + 2;
+    m_squares = (m_settings.row_size + 2) * m_stride;
+    clearBoards();
+}
+
+void GameBatch::clearBoards() {
+    // everything starts out as halo (revealed, negative count), and the board squares are
+    // cleared afterwards
+    const size_t planes = size_t(m_squares) * m_count;
+    m_mines.assign(planes, 0);
+    m_revealed.assign(planes, 1);
+    m_adjacent.assign(planes, -1);
+    for (int32_t i = 0; i < m_settings.row_size; i++) {
+        const size_t begin = index(0, i, 0);
+        const size_t end = index(0, i, m_settings.col_size);
+        std::fill(m_revealed.begin() + begin, m_revealed.begin() + end, 0);
+        std::fill(m_adjacent.begin() + begin, m_adjacent.begin() + end, 0);
+    }
+
+    m_status.assign(m_count, BatchStatus::Playing);
+    m_revealed_count.assign(m_count, 0);
+}
+
+bool GameBatch::generateMines(const std::vector<GameBoardCoord>& first_clicks) {
+    assert(int32_t(first_clicks.size()) == m_count);
+    for (const GameBoardCoord& first_click : first_clicks) {
+        if (!isFeasible(m_settings, first_click))
+            return false;
+    }
+    const int32_t max_row = m_settings.row_size;
+    const int32_t max_col = m_settings.col_size;
+
+    // a second call generates new games rather than adding mines to the previous ones
+    clearBoards();
+
+    std::vector<uint64_t> keys(m_count);
+    std::vector<uint64_t> counters(m_count, 0);
+    std::vector<uint32_t> candidates(m_count);
+    std::vector<int32_t> placed(m_count, 0);
+    for (int32_t b = 0; b < m_count; b++)
+        keys[b] = mixBits(m_settings.seed ^ mixBits(b));
+
+    // every round draws one candidate square for every board at once and then places the
+    // candidates that are allowed. boards that are already full keep drawing, which is
+    // cheaper than keeping the draw loop free of branches
+    int32_t remaining = (m_settings.num_mines > 0) ? m_count : 0;
+    while (remaining > 0) {
+        for (int32_t b = 0; b < m_count; b++)
+            candidates[b] = scaleRandom(counterRandom(keys[b], counters[b]++) >> 32, max_row * max_col);
+
+        for (int32_t b = 0; b < m_count; b++) {
+            if (placed[b] == m_settings.num_mines)
+                continue;
+
+            const int32_t row = candidates[b] / max_col;
+            const int32_t col = candidates[b] % max_col;
+            const int32_t row_dist = std::abs(row - first_clicks[b].row);
+            const int32_t col_dist = std::abs(col - first_clicks[b].col);
+            if (m_settings.is_clear_first_move && row_dist <= 1 && col_dist <= 1)
+                continue;
+            if (m_settings.is_safe_first_move && !row_dist && !col_dist)
+                continue;
+
+            uint8_t& mine = m_mines[index(b, row, col)];
+            if (mine)
+                continue;
+            mine = 1;
+            if (++placed[b] == m_settings.num_mines)
+                remaining--;
+        }
+    }
+
+    countAdjacent();
+    return true;
+}
+
+void GameBatch::countAdjacent() {
+    std::array<ptrdiff_t, 8> offsets = {};
+    for (int32_t k = 0; k < 8; k++)
+        offsets[k] = ptrdiff_t(dir_row[k] * m_stride + dir_col[k]) * m_count;
+
+    // the innermost loop runs over the same square of every board, which is contiguous
+    for (int32_t i = 0; i < m_settings.row_size; i++) {
+        for (int32_t j = 0; j < m_settings.col_size; j++) {
+            int8_t* adjacent = &m_adjacent[index(0, i, j)];
+            const uint8_t* mines = &m_mines[index(0, i, j)];
+            std::fill_n(adjacent, m_count, 0);
+            for (int32_t k = 0; k < 8; k++) {
+                for (int32_t b = 0; b < m_count; b++)
+                    adjacent[b] += mines[offsets[k] + b];
+            }
+        }
+    }
+}
+
+void GameBatch::reveal(const std::vector<GameBoardCoord>& coords) {
+    assert(int32_t(coords.size()) == m_count);
+    const int32_t safe_squares = m_settings.row_size * m_settings.col_size - m_settings.num_mines;
+    for (int32_t b = 0; b < m_count; b++) {
+        if (m_status[b] != BatchStatus::Playing || coords[b].row < 0)
+            continue;
+
+        const size_t square = index(b, coords[b].row, coords[b].col);
+        if (m_revealed[square])
+            continue;
+        if (m_mines[square]) {
+            m_revealed[square] = 1;
+            m_status[b] = BatchStatus::Lost;
+            continue;
+        }
+
+        floodfill(b, square);
+        if (m_revealed_count[b] == safe_squares)
+            m_status[b] = BatchStatus::Won;
+    }
+}
+
+void GameBatch::floodfill(int32_t board, size_t start) {
+    std::array<ptrdiff_t, 8> offsets = {};
+    for (int32_t k = 0; k < 8; k++)
+        offsets[k] = ptrdiff_t(dir_row[k] * m_stride + dir_col[k]) * m_count;
+
+    m_queue.clear();
+    m_queue.push_back(start);
+    m_revealed[start] = 1;
+    int32_t revealed = 1;
+    for (size_t head = 0; head < m_queue.size(); head++) {
+        const size_t curr = m_queue[head];
+        if (m_adjacent[curr])
+            continue;
+        for (int32_t k = 0; k < 8; k++) {
+            // the halo is revealed, so it is never entered
+            const size_t next = curr + offsets[k];
+            if (m_mines[next] || m_revealed[next])
+                continue;
+            m_revealed[next] = 1;
+            m_queue.push_back(next);
+            revealed++;
+        }
+    }
+
+    m_revealed_count[board] += revealed;
+}
+
+int32_t GameBatch::size() const {
+    return m_count;
+}
+
+int32_t GameBatch::rowSize() const {
+    return m_settings.row_size;
+}
+
+int32_t GameBatch::colSize() const {
+    return m_settings.col_size;
+}
+
+const std::vector<BatchStatus>& GameBatch::status() const {
+    return m_status;
+}
+
+const std::vector<int32_t>& GameBatch::revealedCount() const {
+    return m_revealed_count;
+}
+
+bool GameBatch::isMine(int32_t board, const GameBoardCoord& coord) const {
+    return m_mines[index(board, coord.row, coord.col)];
+}
+
+bool GameBatch::isRevealed(int32_t board, const GameBoardCoord& coord) const {
+    return m_revealed[index(board, coord.row, coord.col)];
+}
+
+int32_t GameBatch::adjacentMines(int32_t board, const GameBoardCoord& coord) const {
+    return m_adjacent[index(board, coord.row, coord.col)];
+}
+
+size_t GameBatch::index(int32_t board, int32_t row, int32_t col) const {
+    // the planes hold every board, so they outgrow 32 bits long before a single board does
+    return (size_t(row + 1) * m_stride + col + 1) * m_count + board;
+}
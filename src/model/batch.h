@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "model/data.h"
+#include "model/board.h"
+
+enum class BatchStatus : uint8_t {
+    Playing = 0,
+    Won = 1,
+    Lost = 2
+};
+
+// many independent games of the same size and settings, advanced together for mass
+// simulation. unlike GameBoard there is no undo, marking or change tracking, and the
+// boards are stored as a structure of arrays: one array per square field, where square k
+// of every board is stored next to square k of the next board. loops that touch the same
+// square of all boards (mine counting, win checks) therefore run over contiguous memory.
+//
+// squares are padded with the same sentinel halo as GameBoard, so neighbour loops need
+// no bounds checks
+class GameBatch {
+public:
+    GameBatch(const GameSettings& settings, int32_t count);
+
+    // generates the mines of every board, with board i keeping first_clicks[i] free
+    // according to the first move settings. any game already in the batch is cleared first. board i draws from its own random stream
+    // derived from the settings seed and i, so a batch is reproducible. fails without
+    // placing anything if the mines do not fit around one of the first clicks
+    bool generateMines(const std::vector<GameBoardCoord>& first_clicks);
+    // applies one reveal to every board. boards that already ended, and boards whose
+    // coordinate has a negative row, are skipped. revealing a revealed square does nothing
+    void reveal(const std::vector<GameBoardCoord>& coords);
+
+    int32_t size() const;
+    int32_t rowSize() const;
+    int32_t colSize() const;
+
+    const std::vector<BatchStatus>& status() const;
+    const std::vector<int32_t>& revealedCount() const;
+    bool isMine(int32_t board, const GameBoardCoord& coord) const;
+    bool isRevealed(int32_t board, const GameBoardCoord& coord) const;
+    int32_t adjacentMines(int32_t board, const GameBoardCoord& coord) const;
+
+private:
+    size_t index(int32_t board, int32_t row, int32_t col) const;
+    void clearBoards();
+    void countAdjacent();
+    void floodfill(int32_t board, size_t start);
+
+private:
+    GameSettings m_settings;
+    int32_t m_count = 0;
+    int32_t m_stride = 0, m_squares = 0; // per board, including the halo
+
+    std::vector<uint8_t> m_mines = {};
+    std::vector<uint8_t> m_revealed = {};
+    std::vector<int8_t> m_adjacent = {};
+
+    std::vector<BatchStatus> m_status = {};
+    std::vector<int32_t> m_revealed_count = {};
+    std::vector<size_t> m_queue = {};
+};
@@ -3,22 +3,37 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <thread>
 #include <random>
 #include <vector>
-#include <queue>
+#include <utility>
+#include <algorithm>
 
 #include "model/board.h"
+#include "model/feasibility.h"
+#include "model/kernel.h"
+#include "model/random.h"
 
 namespace {
 
-    // whether or not a coordinate is valid within a larger matrix/2d array
-    bool isValid(int32_t curr_row, int32_t curr_col, int32_t max_row, int32_t max_col) {
-        return curr_row >= 0 && curr_col >= 0 && curr_row < max_row && curr_col < max_col;
+    constexpr int32_t dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    constexpr int32_t dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+    // storage offsets of the eight neighbours of a square, in the order of dir_row/dir_col
+    std::array<int32_t, 8> neighbourOffsets(int32_t stride) {
+        std::array<int32_t, 8> ret = {};
+        for (int32_t k = 0; k < 8; k++)
+            ret[k] = dir_row[k] * stride + dir_col[k];
+        return ret;
     }
 
-    // generate a random number in the [lower, upper] interval inclusive
+    // generate a random number in the [lower, upper] interval inclusive. the interval may
+    // be a single number, e.g. the rows of a board with one row
     int32_t randomNum(int32_t lower_range, int32_t upper_range, std::mt19937& seed) {
-        assert(upper_range > lower_range);
+        assert(upper_range >= lower_range);
         std::uniform_int_distribution<int32_t> dist(lower_range, upper_range);
         return dist(seed);
     }
@@ -27,15 +42,105 @@ namespace {
 
 GameBoard::GameBoard(const GameSettings& settings) : m_settings(settings) {
     m_settings = settings;
-    m_board.assign(m_settings.row_size, std::vector<GameBoardSquare>(
-        m_settings.col_size, 
-        GameBoardSquare()
-    ));
+    initSquares();
+}
+
+void GameBoard::initSquares() {
+    m_rows = m_settings.row_size;
+    m_cols = m_settings.col_size;
+    m_stride = m_cols + 2;
+    m_squares.assign((m_rows + 2) * m_stride, s_halo);
+    for (int32_t i = 0; i < m_rows; i++)
+        std::fill_n(m_squares.begin() + index(i, 0), m_cols, GameBoardSquare());
 }
 
-void GameBoard::generateMines(const GameBoardCoord& init) {
+bool GameBoard::generateMines(const GameBoardCoord& init) {
+    if (!isFeasible(m_settings, init))
+        return false;
     generateMinesImpl(init);
     countAdjacent();
+    labelRegions();
+    return true;
+}
+
+bool GameBoard::preloadMines(const GameBoardCoord& anchor) {
+    if (!generateMines(anchor))
+        return false;
+    m_is_preloaded = true;
+    return true;
+}
+
+bool GameBoard::preloadMines(const std::vector<uint8_t>& bitmap) {
+    if (int32_t(bitmap.size()) != (m_rows * m_cols + 7) / 8)
+        return false;
+
+    for (int32_t i = 0; i < m_rows * m_cols; i++) {
+        if ((bitmap[i / 8] >> (i % 8)) & 1)
+            modify(index(i / m_cols, i % m_cols)).is_mine = true;
+    }
+
+    countAdjacent();
+    labelRegions();
+    m_is_preloaded = true;
+    return true;
+}
+
+std::vector<uint8_t> GameBoard::mineBitmap() const {
+    std::vector<uint8_t> bitmap((m_rows * m_cols + 7) / 8, 0);
+    for (int32_t i = 0; i < m_rows * m_cols; i++)
+        bitmap[i / 8] |= uint8_t(at(i / m_cols, i % m_cols).is_mine) << (i % 8);
+    return bitmap;
+}
+
+std::vector<uint8_t> GameBoard::visibleBitmap() const {
+    std::vector<uint8_t> bitmap((m_rows * m_cols + 1) / 2, 0);
+    for (int32_t i = 0; i < m_rows * m_cols; i++) {
+        const GameBoardSquare& square = at(i / m_cols, i % m_cols);
+        const uint8_t bits = uint8_t(square.is_revealed) | uint8_t(square.is_marked) << 1
+            | uint8_t(square.is_question) << 2 | uint8_t(square.is_end_reason) << 3;
+        bitmap[i / 2] |= bits << (4 * (i % 2));
+    }
+    return bitmap;
+}
+
+bool GameBoard::restore(const std::vector<uint8_t>& mines, const std::vector<uint8_t>& visible) {
+    if (int32_t(visible.size()) != (m_rows * m_cols + 1) / 2 || !preloadMines(mines))
+        return false;
+
+    // squares that are still plain hidden are skipped, so that only the squares the
+    // player has touched end up in the changed list
+    for (int32_t i = 0; i < m_rows * m_cols; i++) {
+        const uint8_t bits = (visible[i / 2] >> (4 * (i % 2))) & 0xF;
+        if (!bits)
+            continue;
+        GameBoardSquare& square = modify(index(i / m_cols, i % m_cols));
+        square.is_revealed = bits & 1;
+        square.is_marked = bits & 2;
+        square.is_question = bits & 4;
+        square.is_end_reason = bits & 8;
+    }
+
+    return true;
+}
+
+int32_t GameBoard::regionCount() const {
+    return m_region_offsets.empty() ? 0 : m_region_offsets.size() - 1;
+}
+
+bool GameBoard::isOpenedByRegion(const GameBoardCoord& coord) const {
+    if (m_labels.empty())
+        return false;
+
+    // the halo is never labelled, so the neighbours need no bounds checks
+    const int32_t center = index(coord.row, coord.col);
+    if (m_labels[center] >= 0)
+        return true;
+    for (const int32_t offset : neighbourOffsets(m_stride)) {
+        if (m_labels[center + offset] >= 0)
+            return true;
+    }
+
+    return false;
 }
 
 void GameBoard::updateSettings(const GameSettings& new_settings) {
@@ -45,34 +150,37 @@ void GameBoard::updateSettings(const GameSettings& new_settings) {
 void GameBoard::gameOverRevealMines(const GameBoardCoord& last_reveal) {
     for (int32_t i = 0; i < rowSize(); i++) {
         for (int32_t j = 0; j < colSize(); j++) {
-            if (!m_board[i][j].is_mine && !m_board[i][j].is_marked)
+            if (!at(i, j).is_mine && !at(i, j).is_marked)
                 continue; // we do not want to do anything with marked mines
             if (i == last_reveal.row && j == last_reveal.col) {
-                m_board[i][j].is_revealed = true;
-                m_board[i][j].is_end_reason = true;
-            } else if (!m_board[i][j].is_mine && m_board[i][j].is_marked) {
-                m_board[i][j].is_revealed = true; // wrongly marked mine
-            } else if (m_board[i][j].is_mine && !m_board[i][j].is_marked) {
-                m_board[i][j].is_revealed = true; // not marked mine
+                modify(index(i, j)).is_revealed = true;
+                at(i, j).is_end_reason = true;
+            } else if (!at(i, j).is_mine && at(i, j).is_marked) {
+                modify(index(i, j)).is_revealed = true; // wrongly marked mine
+            } else if (at(i, j).is_mine && !at(i, j).is_marked) {
+                modify(index(i, j)).is_revealed = true; // not marked mine
             }
         }
     }
 }
 
 void GameBoard::gameWonMarkMines() {
-    for (int32_t i = 0; i < m_board.size(); i++) {
-        for (int32_t j = 0; j < m_board[0].size(); j++) {
-            if (m_board[i][j].is_mine) {
-                m_board[i][j].is_marked = true;
+    for (int32_t i = 0; i < rowSize(); i++) {
+        for (int32_t j = 0; j < colSize(); j++) {
+            if (at(i, j).is_mine && !at(i, j).is_marked) {
+                modify(index(i, j)).is_marked = true;
             }
         }
     }
 }
 
 void GameBoard::mark(const GameBoardCoord& coord, GameState& state) {
-    GameBoardSquare& square = m_board[coord.row][coord.col];
-    if (state.lost || state.won || square.is_revealed)
+    revealAdjacentUp();
+    if (state.lost || state.won || at(coord.row, coord.col).is_revealed)
         return;
+
+    beginAction(state);
+    GameBoardSquare& square = modify(index(coord.row, coord.col));
     if (m_settings.is_question_enabled) {
         if (square.is_marked) {
             square.is_marked = false;
@@ -93,59 +201,93 @@ void GameBoard::mark(const GameBoardCoord& coord, GameState& state) {
             state.mines--;
         }
     }
+
+    // a flag can complete a number, so an auto chord may open squares and win the game
+    if (assistImpl(state) && !state.lost && didWin()) {
+        gameWonMarkMines();
+        state.won = true;
+    }
+
+    commitAction(state);
 }
 
 void GameBoard::reveal(const GameBoardCoord& coord, GameState& state) {
-    if (state.lost || state.won || m_board[coord.row][coord.col].is_marked)
+    revealAdjacentUp();
+    if (state.lost || state.won || at(coord.row, coord.col).is_marked)
         return;
-    if (m_board[coord.row][coord.col].is_mine) {
+
+    beginAction(state);
+    if (state.is_first_reveal && !m_is_preloaded) {
+        // nothing to play on, and the reveal stays a first reveal
+        if (!generateMines(coord)) {
+            commitAction(state);
+            return;
+        }
+        state.first_row = coord.row;
+        state.first_col = coord.col;
+    }
+    if (at(coord.row, coord.col).is_mine) {
         state.lost = true;
         gameOverRevealMines(coord);
-    } else if (!m_board[coord.row][coord.col].is_revealed) {
-        floodfillImpl(coord);
+    } else if (!at(coord.row, coord.col).is_revealed) {
+        floodfillImpl(index(coord.row, coord.col));
     } else if (revealAdjacentImpl(coord)) {
         gameOverRevealMines(coord);
         state.lost = true;
     }
 
+    if (!state.lost)
+        assistImpl(state);
     if (didWin()) {
         gameWonMarkMines();
         state.won = true;
     }
 
     state.is_first_reveal = false;
+    commitAction(state);
 }
 
 void GameBoard::reset(const GameSettings& settings) {
     m_settings = settings;
-    m_board.assign(m_settings.row_size, std::vector<GameBoardSquare>(
-        m_settings.col_size, 
-        GameBoardSquare()
-    ));
+    initSquares();
+
+    m_preview.clear();
+    m_changed.clear();
+    m_labels.clear();
+    m_region_offsets.clear();
+    m_region_squares.clear();
+    m_border_offsets.clear();
+    m_border_squares.clear();
+    m_is_preloaded = false;
+    m_pending.changes.clear();
+    m_undo.clear();
+    m_redo.clear();
+    m_assist.clear();
+    m_assist_queued.clear();
+    m_assist_revealed = false;
 }
 
 void GameBoard::revealAdjacentUp() {
-    if (!m_internal_copy.empty()) {
-        m_board = m_internal_copy;
-        m_internal_copy = {};
+    // restore only the (at most eight) squares that were changed for the preview
+    for (const GameBoardChange& change : m_preview) {
+        at(change.coord.row, change.coord.col) = change.square;
+        m_changed.push_back(change.coord);
     }
+    m_preview.clear();
 }
 
 void GameBoard::revealAdjacentDown(const GameBoardCoord& coord) {
-    const GameBoardSquare& square = m_board[coord.row][coord.col];
+    revealAdjacentUp();
+    const GameBoardSquare& square = at(coord.row, coord.col);
     if (!square.is_revealed || !square.adjacent_mines)
         return;
 
-    m_internal_copy = m_board;
-    constexpr int dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-    constexpr int dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
     for (int32_t i = 0; i < 8; i++) {
-        const int32_t new_row = coord.row + dir_row[i];
-        const int32_t new_col = coord.col + dir_col[i];
-        GameBoardSquare& sq = m_board[new_row][new_col];
-        if (!isValid(new_row, new_col, rowSize(), colSize()))
-            continue;
+        const GameBoardCoord adj = { coord.row + dir_row[i], coord.col + dir_col[i] };
+        GameBoardSquare& sq = at(adj.row, adj.col);
         if (!sq.is_marked && !sq.is_revealed) {
+            m_preview.push_back({ adj, sq });
+            m_changed.push_back(adj);
             sq.is_revealed = true;
             sq.is_mine = false;
             sq.adjacent_mines = 0;
@@ -153,12 +295,132 @@ void GameBoard::revealAdjacentDown(const GameBoardCoord& coord) {
     }
 }
 
+void GameBoard::assist(GameState& state) {
+    revealAdjacentUp();
+    if (state.lost || state.won) {
+        clearAssist();
+        return;
+    }
+    if (m_assist.empty())
+        return;
+
+    // the win check looks at every square, so it waits until the work is done. until
+    // then there are numbers left with closed squares around them anyway
+    beginAction(state);
+    m_assist_revealed |= assistImpl(state);
+    if (m_assist_revealed && m_assist.empty() && !state.lost && didWin()) {
+        gameWonMarkMines();
+        state.won = true;
+    }
+    if (m_assist.empty())
+        m_assist_revealed = false;
+
+    // the work belongs to the move that left it, so it is not a click of its own and a
+    // single undo takes back both. the move did change something, so it is on the stack
+    assert(!m_undo.empty());
+    m_recording = false;
+    std::vector<GameBoardChange>& changes = m_undo.back().changes;
+    changes.insert(changes.end(), m_pending.changes.begin(), m_pending.changes.end());
+    m_pending.changes.clear();
+}
+
+bool GameBoard::hasAssistWork() const {
+    return !m_assist.empty();
+}
+
+bool GameBoard::undo(GameState& state) {
+    revealAdjacentUp();
+    clearAssist(); // otherwise the assists would redo what was just undone
+    if (m_undo.empty())
+        return false;
+
+    m_redo.push_back(std::move(m_undo.back()));
+    m_undo.pop_back();
+    applyAction(m_redo.back(), state, true);
+    return true;
+}
+
+bool GameBoard::redo(GameState& state) {
+    revealAdjacentUp();
+    clearAssist();
+    if (m_redo.empty())
+        return false;
+
+    m_undo.push_back(std::move(m_redo.back()));
+    m_redo.pop_back();
+    applyAction(m_undo.back(), state, false);
+    return true;
+}
+
+bool GameBoard::canUndo() const {
+    return !m_undo.empty();
+}
+
+bool GameBoard::canRedo() const {
+    return !m_redo.empty();
+}
+
+const std::vector<GameBoardCoord>& GameBoard::changedSquares() const {
+    return m_changed;
+}
+
+void GameBoard::clearChangedSquares() {
+    m_changed.clear();
+}
+
+GameBoardSquare& GameBoard::modify(int32_t index) {
+    m_changed.push_back(coordOf(index));
+    if (m_recording)
+        m_pending.changes.push_back({ coordOf(index), m_squares[index] });
+    return m_squares[index];
+}
+
+void GameBoard::beginAction(const GameState& state) {
+    m_recording = true;
+    m_assist_fed = 0;
+    m_pending.state = state;
+    m_pending.changes.clear();
+}
+
+void GameBoard::commitAction(GameState& state) {
+    m_recording = false;
+    if (m_pending.changes.empty() && m_pending.state == state)
+        return;
+    // only actions that did something count as clicks, and undo takes them back
+    state.clicks++;
+    m_undo.push_back(std::move(m_pending));
+    m_pending = GameBoardAction();
+    m_redo.clear();
+}
+
+void GameBoard::applyAction(GameBoardAction& action, GameState& state, bool backwards) {
+    // swapping the saved squares with the board turns an undo entry into its redo entry
+    // and vice versa. a square may have been saved more than once within an action, so
+    // undoing has to walk the changes backwards and redoing has to walk them forwards
+    if (backwards) {
+        for (auto it = action.changes.rbegin(); it != action.changes.rend(); it++)
+            std::swap(at(it->coord.row, it->coord.col), it->square);
+    } else {
+        for (auto it = action.changes.begin(); it != action.changes.end(); it++)
+            std::swap(at(it->coord.row, it->coord.col), it->square);
+    }
+
+    for (const GameBoardChange& change : action.changes)
+        m_changed.push_back(change.coord);
+
+    const int64_t timer = state.timer;
+    const bool revealing_mine = state.revealing_mine;
+    std::swap(state, action.state);
+    state.timer = timer;
+    state.revealing_mine = revealing_mine;
+}
+
 const GameBoardSquare& GameBoard::getSquare(const GameBoardCoord& get_coord) const {
-    return m_board[get_coord.row][get_coord.col];
+    return at(get_coord.row, get_coord.col);
 }
 
 GameBoardSquare& GameBoard::getSquare(const GameBoardCoord& get_coord) {
-    return m_board[get_coord.row][get_coord.col];
+    return at(get_coord.row, get_coord.col);
 }
 
 uint32_t GameBoard::getSeed() const {
@@ -166,11 +428,11 @@ uint32_t GameBoard::getSeed() const {
 }
 
 int32_t GameBoard::rowSize() const {
-    return m_board.size();
+    return m_rows;
 }
 
 int32_t GameBoard::colSize() const {
-    return m_board[0].size();
+    return m_cols;
 }
 
 namespace {
@@ -191,23 +453,38 @@ namespace {
 }
 
 void GameBoard::generateMinesImpl(const GameBoardCoord& guarantee) {
-    std::mt19937 engine(m_settings.seed);
-
     bool (*validCondition)(int32_t, int32_t, int32_t, int32_t) = alwaysValid;
     if (m_settings.is_safe_first_move)
         validCondition = isOutsideSafeZone;
     if (m_settings.is_clear_first_move)
         validCondition = isOutsideClearZone;
 
-    for (int32_t i = 0; i < m_settings.num_mines; i++) {
-        int32_t curr_row = randomNum(0, rowSize() - 1, engine);
-        int32_t curr_col = randomNum(0, colSize() - 1, engine);
-        while (m_board[curr_row][curr_col].is_mine || !validCondition(curr_row, curr_col, guarantee.row, guarantee.col)) {
-            curr_row = randomNum(0, rowSize() - 1, engine);
-            curr_col = randomNum(0, colSize() - 1, engine);
-        }
+    auto place = [&](auto&& randomSquare) {
+        for (int32_t i = 0; i < m_settings.num_mines; i++) {
+            GameBoardCoord curr = randomSquare();
+            while (at(curr.row, curr.col).is_mine || !validCondition(curr.row, curr.col, guarantee.row, guarantee.col))
+                curr = randomSquare();
 
-        m_board[curr_row][curr_col].is_mine = true;
+            modify(index(curr.row, curr.col)).is_mine = true;
+        }
+    };
+
+    if (m_settings.generator == GameGenerator::Xoshiro) {
+        // one draw per attempt, split into a row and a column
+        Xoshiro256 engine(m_settings.seed);
+        const uint32_t square_count = rowSize() * colSize();
+        place([&]() {
+            const int32_t square = boundedRandom(engine, square_count);
+            return GameBoardCoord{ square / colSize(), square % colSize() };
+        });
+    } else {
+        // kept exactly as it was, so that existing seeds keep their layouts
+        std::mt19937 engine(m_settings.seed);
+        place([&]() {
+            const int32_t row = randomNum(0, rowSize() - 1, engine);
+            const int32_t col = randomNum(0, colSize() - 1, engine);
+            return GameBoardCoord{ row, col };
+        });
     }
 }
 
@@ -215,99 +492,450 @@ bool GameBoard::revealAdjacentImpl(const GameBoardCoord& coord) {
     revealAdjacentUp();
     bool is_mine = false;
     int flag_nums = 0;
-    constexpr int dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-    constexpr int dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    const int32_t center = index(coord.row, coord.col);
+    const std::array<int32_t, 8> offset = neighbourOffsets(m_stride);
+
     for (int i = 0; i < 8; i++) {
-        const int new_row = coord.row + dir_row[i];
-        const int new_col = coord.col + dir_col[i];
-        if (!isValid(new_row, new_col, rowSize(), colSize()))
-            continue;
-        if (m_board[new_row][new_col].is_marked) {
-            flag_nums++;
-        } else if (m_board[new_row][new_col].is_mine) {
-            is_mine = true;
-        }
+        const GameBoardSquare& square = m_squares[center + offset[i]];
+        flag_nums += square.is_marked;
+        is_mine |= square.is_mine && !square.is_marked;
     }
 
-
-    if (flag_nums != m_board[coord.row][coord.col].adjacent_mines)
+    if (flag_nums != m_squares[center].adjacent_mines)
         return false;
     for (int i = 0; i < 8; i++) {
-        const int new_row = coord.row + dir_row[i];
-        const int new_col = coord.col + dir_col[i];
-        if (!isValid(new_row, new_col, rowSize(), colSize()) || m_board[new_row][new_col].is_marked)
+        const int32_t adj = center + offset[i];
+        if (m_squares[adj].is_marked)
             continue;
-        if (m_board[new_row][new_col].is_mine) {
-            m_board[new_row][new_col].is_end_reason = true;
+        if (m_squares[adj].is_mine) {
+            modify(adj).is_end_reason = true;
         } else if (is_mine) {
-            m_board[new_row][new_col].is_revealed = true;
+            if (!m_squares[adj].is_revealed) // also skips the halo
+                modify(adj).is_revealed = true;
         } else {
-            floodfillImpl({ new_row, new_col });
+            floodfillImpl(adj); // a no-op on the halo, which counts as revealed
         }
     }
     
     return is_mine;
 }
 
+bool GameBoard::assistImpl(GameState& state) {
+    if (!m_settings.is_auto_chord && !m_settings.is_auto_flag) {
+        clearAssist(); // the assists were turned off with work left
+        return false;
+    }
+    if (m_assist_queued.size() != m_squares.size())
+        m_assist_queued.assign(m_squares.size(), 0);
+
+    const std::array<int32_t, 8> offset = neighbourOffsets(m_stride);
+    int32_t budget = std::max(m_settings.assist_budget, 1);
+    bool is_revealed = false;
+    while (!state.lost) {
+        // takes in everything the action changed so far, including what the assists did.
+        // a square that was and still is plain hidden (its count or mine was set) changes
+        // nothing for the numbers around it, which keeps the first reveal cheap
+        for (; m_assist_fed < m_pending.changes.size(); m_assist_fed++) {
+            const GameBoardChange& change = m_pending.changes[m_assist_fed];
+            const int32_t center = index(change.coord.row, change.coord.col);
+            const GameBoardSquare& square = m_squares[center];
+            if (!square.is_revealed && !square.is_marked && !change.square.is_revealed && !change.square.is_marked)
+                continue;
+            queueAssist(center);
+            for (int32_t i = 0; i < 8; i++)
+                queueAssist(center + offset[i]);
+        }
+
+        if (m_assist.empty() || budget <= 0)
+            break;
+        const int32_t center = m_assist.back();
+        m_assist.pop_back();
+        m_assist_queued[center] = 0;
+        is_revealed |= assistSquare(center, state);
+        budget--;
+    }
+
+    if (state.lost)
+        clearAssist();
+    return is_revealed;
+}
+
+bool GameBoard::assistSquare(int32_t center, GameState& state) {
+    // the square may have changed since it was listed
+    const GameBoardSquare& square = m_squares[center];
+    if (!square.is_revealed || square.is_mine || square.adjacent_mines <= 0)
+        return false;
+
+    const std::array<int32_t, 8> offset = neighbourOffsets(m_stride);
+    int32_t flagged = 0, hidden = 0;
+    for (int32_t i = 0; i < 8; i++) {
+        const GameBoardSquare& adj = m_squares[center + offset[i]];
+        if (!adj.is_revealed) // also skips the halo
+            (adj.is_marked ? flagged : hidden)++;
+    }
+
+    if (!hidden)
+        return false;
+    if (m_settings.is_auto_flag && flagged + hidden == square.adjacent_mines) {
+        for (int32_t i = 0; i < 8; i++) {
+            const int32_t adj = center + offset[i];
+            if (m_squares[adj].is_revealed || m_squares[adj].is_marked)
+                continue;
+            GameBoardSquare& marked = modify(adj);
+            marked.is_marked = true;
+            marked.is_question = false;
+            state.mines--;
+        }
+        return false;
+    }
+
+    // the same as a chord by the player, so a wrong flag loses the game
+    if (m_settings.is_auto_chord && flagged == square.adjacent_mines) {
+        const GameBoardCoord coord = coordOf(center);
+        if (revealAdjacentImpl(coord)) {
+            gameOverRevealMines(coord);
+            state.lost = true;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void GameBoard::queueAssist(int32_t index) {
+    const GameBoardSquare& square = m_squares[index];
+    if (m_assist_queued[index] || !square.is_revealed || square.is_mine || square.adjacent_mines <= 0)
+        return;
+    m_assist_queued[index] = 1;
+    m_assist.push_back(index);
+}
+
+void GameBoard::clearAssist() {
+    for (const int32_t index : m_assist)
+        m_assist_queued[index] = 0;
+    m_assist.clear();
+    m_assist_revealed = false;
+}
+
 void GameBoard::countAdjacent() {
-    const int32_t max_row = rowSize();
-    const int32_t max_col = colSize();
-    for (int32_t i = 0; i < max_row; i++) {
-        for (int32_t j = 0; j < max_col; j++) {
-            constexpr int dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-            constexpr int dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
-            
-            for (int32_t k = 0; k < 8; k++) {
-                const int adj_row = i + dir_row[k];
-                const int adj_col = j + dir_col[k];
-                if (adj_row < 0 || adj_col < 0 || adj_row >= max_row || adj_col >= max_col)
+    dispatchDims(m_rows, m_cols, [this](auto dims) {
+        using Kernel = BoardKernel<decltype(dims)>;
+        Kernel::countAdjacent(dims, typename Kernel::Squares(m_squares.data(), m_squares.size()), [this](int32_t index) -> GameBoardSquare& {
+            return modify(index);
+        });
+    });
+}
+
+void GameBoard::floodfillImpl(int32_t start) {
+    // a numbered square opens only itself. chords (and so the auto chord) mostly open
+    // those, and the parallel fill would set up for the whole board every time
+    if (m_squares[start].adjacent_mines != 0) {
+        if (!m_squares[start].is_revealed)
+            modify(start).is_revealed = true;
+        return;
+    }
+
+    if (!m_labels.empty()) {
+        const int32_t label = m_labels[start];
+        if (label >= 0 && revealRegionImpl(label))
+            return;
+    }
+
+    if (rowSize() * colSize() >= s_parallel_min_squares) {
+        floodfillParallelImpl(start);
+        return;
+    }
+
+    dispatchDims(m_rows, m_cols, [this, start](auto dims) {
+        using Kernel = BoardKernel<decltype(dims)>;
+        Kernel::floodfill(dims, typename Kernel::Squares(m_squares.data(), m_squares.size()), start, m_queue, [this](int32_t index) -> GameBoardSquare& {
+            return modify(index);
+        });
+    });
+}
+
+namespace {
+
+    int32_t findRoot(std::vector<int32_t>& parent, int32_t index) {
+        while (parent[index] != index) {
+            parent[index] = parent[parent[index]]; // path halving
+            index = parent[index];
+        }
+
+        return index;
+    }
+
+    void unite(std::vector<int32_t>& parent, int32_t first, int32_t second) {
+        first = findRoot(parent, first);
+        second = findRoot(parent, second);
+        if (first != second)
+            parent[std::max(first, second)] = std::min(first, second);
+    }
+
+    // runs work(0) to work(count - 1) at the same time, the first on the calling thread
+    template <typename Work>
+    void runParallel(int32_t count, Work&& work) {
+        std::vector<std::jthread> threads;
+        for (int32_t id = 1; id < count; id++)
+            threads.emplace_back(work, id);
+        work(0);
+    }
+
+}
+
+void GameBoard::labelRegions() {
+    const int32_t size = m_squares.size();
+    const std::array<int32_t, 8> offset = neighbourOffsets(m_stride);
+
+    // large boards are labelled in one strip of rows per thread, which is what makes a
+    // first click on them fast: the labels are the search of the first flood fill. every
+    // step gives the same labels, regions and borders as a single strip
+    const int32_t strips = (rowSize() * colSize() >= s_parallel_min_squares)
+        ? std::clamp<int32_t>(std::thread::hardware_concurrency(), 1, std::min(16, m_rows)) : 1;
+    auto firstRow = [this, strips](int32_t strip) {
+        return int32_t(int64_t(m_rows) * strip / strips);
+    };
+    // the storage indices of a strip, halo included, so that the strips cover every square
+    auto stripBegin = [this, &firstRow](int32_t strip) {
+        return index(firstRow(strip), 0);
+    };
+
+    // the halo has a negative count, so it is never a zero square
+    auto isZero = [this](int32_t index) {
+        return !m_squares[index].is_mine && !m_squares[index].adjacent_mines;
+    };
+
+    // m_labels doubles as the union-find parent array. scanning in storage order, each
+    // zero square only has to be joined with the four neighbours that were already seen.
+    // the first row of a strip is not joined with the row above it, so every union stays
+    // inside its strip and the strips need no locking. the seams are joined afterwards
+    m_labels.assign(size, -1);
+    runParallel(strips, [&](int32_t strip) {
+        for (int32_t i = firstRow(strip); i < firstRow(strip + 1); i++) {
+            for (int32_t j = 0; j < m_cols; j++) {
+                const int32_t curr = index(i, j);
+                if (!isZero(curr))
                     continue;
-                if (m_board[adj_row][adj_col].is_mine) {
-                    m_board[i][j].adjacent_mines++;
+
+                m_labels[curr] = curr;
+                for (int32_t k = (strip > 0 && i == firstRow(strip)) ? 3 : 0; k < 4; k++) {
+                    if (isZero(curr + offset[k]))
+                        unite(m_labels, curr, curr + offset[k]);
                 }
             }
         }
+    });
+
+    for (int32_t strip = 1; strip < strips; strip++) {
+        const int32_t i = firstRow(strip);
+        for (int32_t j = 0; j < m_cols; j++) {
+            const int32_t curr = index(i, j);
+            if (!isZero(curr))
+                continue;
+            for (int32_t k = 0; k < 3; k++) {
+                if (isZero(curr + offset[k]))
+                    unite(m_labels, curr, curr + offset[k]);
+            }
+        }
     }
+
+    // roots are always the smallest index of their region. after pointing every square
+    // directly at its root, one forward pass turns the roots into consecutive labels, and
+    // every other square can copy the label of its (already relabelled) root
+    for (int32_t curr = 0; curr < size; curr++) {
+        if (m_labels[curr] >= 0)
+            m_labels[curr] = findRoot(m_labels, curr);
+    }
+
+    int32_t region_count = 0;
+    for (int32_t curr = 0; curr < size; curr++) {
+        if (m_labels[curr] >= 0)
+            m_labels[curr] = (m_labels[curr] == curr) ? region_count++ : m_labels[m_labels[curr]];
+    }
+
+    // the squares and the borders of the regions are both listed with a counting sort:
+    // every strip counts its squares per region, the counts become the position of each
+    // strip within each region, and every strip then writes its squares from there. so a
+    // region lists its squares in storage order, whatever the number of strips
+    std::vector<std::vector<int32_t>> positions(strips);
+    auto toPositions = [&positions, region_count](std::vector<int32_t>& offsets) {
+        offsets.assign(region_count + 1, 0);
+        int32_t total = 0;
+        for (int32_t label = 0; label < region_count; label++) {
+            offsets[label] = total;
+            for (std::vector<int32_t>& position : positions) {
+                const int32_t count = position[label];
+                position[label] = total;
+                total += count;
+            }
+        }
+        offsets[region_count] = total;
+    };
+
+    runParallel(strips, [&](int32_t strip) {
+        std::vector<int32_t>& count = positions[strip];
+        count.assign(region_count, 0);
+        for (int32_t curr = stripBegin(strip); curr < stripBegin(strip + 1); curr++) {
+            if (m_labels[curr] >= 0)
+                count[m_labels[curr]]++;
+        }
+    });
+    toPositions(m_region_offsets);
+    m_region_squares.resize(m_region_offsets[region_count]);
+    runParallel(strips, [&](int32_t strip) {
+        std::vector<int32_t>& position = positions[strip];
+        for (int32_t curr = stripBegin(strip); curr < stripBegin(strip + 1); curr++) {
+            if (m_labels[curr] >= 0)
+                m_region_squares[position[m_labels[curr]]++] = curr;
+        }
+    });
+
+    // a numbered square can border several zero squares of the same region, and is listed
+    // once for every region it borders. squares next to a zero square are never mines,
+    // and the halo has a negative count
+    auto borderedRegions = [&](int32_t curr, std::array<int32_t, 8>& regions) {
+        int32_t found = 0;
+        if (m_squares[curr].adjacent_mines <= 0)
+            return found;
+        for (int32_t d = 0; d < 8; d++) {
+            const int32_t label = m_labels[curr + offset[d]];
+            if (label >= 0 && std::find(regions.begin(), regions.begin() + found, label) == regions.begin() + found)
+                regions[found++] = label;
+        }
+        return found;
+    };
+
+    runParallel(strips, [&](int32_t strip) {
+        std::vector<int32_t>& count = positions[strip];
+        count.assign(region_count, 0);
+        std::array<int32_t, 8> regions;
+        for (int32_t curr = stripBegin(strip); curr < stripBegin(strip + 1); curr++) {
+            const int32_t found = borderedRegions(curr, regions);
+            for (int32_t k = 0; k < found; k++)
+                count[regions[k]]++;
+        }
+    });
+    toPositions(m_border_offsets);
+    m_border_squares.resize(m_border_offsets[region_count]);
+    runParallel(strips, [&](int32_t strip) {
+        std::vector<int32_t>& position = positions[strip];
+        std::array<int32_t, 8> regions;
+        for (int32_t curr = stripBegin(strip); curr < stripBegin(strip + 1); curr++) {
+            const int32_t found = borderedRegions(curr, regions);
+            for (int32_t k = 0; k < found; k++)
+                m_border_squares[position[regions[k]]++] = curr;
+        }
+    });
 }
 
-void GameBoard::floodfillImpl(const GameBoardCoord& start) {
-    std::queue<GameBoardCoord> queue;
-    queue.push(start);
+bool GameBoard::revealRegionImpl(int32_t label) {
+    // revealed or marked squares inside the region would stop a flood fill part way, so
+    // only a region that is still completely untouched can be opened without one
+    for (int32_t k = m_region_offsets[label]; k < m_region_offsets[label + 1]; k++) {
+        const GameBoardSquare& square = m_squares[m_region_squares[k]];
+        if (square.is_revealed || square.is_marked)
+            return false;
+    }
 
-    while (!queue.empty()) {
-        GameBoardCoord curr = queue.front();
-        m_board[curr.row][curr.col].is_revealed = true;
-        queue.pop();
-        constexpr int dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-        constexpr int dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    for (int32_t k = m_region_offsets[label]; k < m_region_offsets[label + 1]; k++)
+        modify(m_region_squares[k]).is_revealed = true;
+    for (int32_t k = m_border_offsets[label]; k < m_border_offsets[label + 1]; k++) {
+        const GameBoardSquare& square = m_squares[m_border_squares[k]];
+        if (!square.is_revealed && !square.is_marked)
+            modify(m_border_squares[k]).is_revealed = true;
+    }
 
-        if (m_board[curr.row][curr.col].adjacent_mines)
-            continue;
+    return true;
+}
+
+void GameBoard::floodfillParallelImpl(int32_t start) {
+    // level-synchronous bfs over storage indices. a square is claimed by atomically setting
+    // its bit in the visited bitmap, so that each square is queued exactly once no matter
+    // which thread reaches it first. the board itself is only read until the search is
+    // over, which makes the set of revealed squares identical to the sequential flood fill
+    const std::array<int32_t, 8> offset = neighbourOffsets(m_stride);
+
+    if (m_visited.size() != (m_squares.size() + 63) / 64)
+        m_visited.assign((m_squares.size() + 63) / 64, 0);
+    auto claim = [this](int32_t index) {
+        const uint64_t bit = uint64_t(1) << (index % 64);
+        return !(std::atomic_ref<uint64_t>(m_visited[index / 64]).fetch_or(bit, std::memory_order_relaxed) & bit);
+    };
+
+    // the halo counts as revealed, so it is never claimed
+    auto expand = [&](int32_t index, std::vector<int32_t>& next) {
+        if (m_squares[index].adjacent_mines)
+            return;
         for (int32_t i = 0; i < 8; i++) {
-            int32_t new_row = curr.row + dir_row[i];
-            int32_t new_col = curr.col + dir_col[i];
-            if (new_row < 0 || new_col < 0 || new_row >= rowSize() || new_col >= colSize())
-                continue;
-            if (m_board[new_row][new_col].is_mine || m_board[new_row][new_col].is_revealed)
+            const int32_t adj = index + offset[i];
+            const GameBoardSquare& square = m_squares[adj];
+            if (square.is_mine || square.is_revealed || square.is_marked)
                 continue;
-            if (m_board[new_row][new_col].is_marked)
-                continue;
-            m_board[new_row][new_col].is_revealed = true;
-            queue.push({ new_row, new_col });
+            if (claim(adj))
+                next.push_back(adj);
         }
+    };
+
+    std::vector<int32_t> order = { start };
+    std::vector<int32_t> frontier = order;
+    claim(start);
+    // small levels are not worth waking up other threads for; most flood fills never
+    // grow past this point even on huge boards
+    std::vector<int32_t> next;
+    while (!frontier.empty() && frontier.size() < s_parallel_min_frontier) {
+        for (const int32_t index : frontier)
+            expand(index, next);
+        order.insert(order.end(), next.begin(), next.end());
+        std::swap(frontier, next);
+        next.clear();
     }
-}
 
-bool GameBoard::didWin() const {
-    for (int i = 0; i < m_board.size(); i++) {
-        for (int j = 0; j < m_board[0].size(); j++) {
-            if (!m_board[i][j].is_revealed && !m_board[i][j].is_mine) {
-                return false;
-            } else if (m_board[i][j].is_revealed && m_board[i][j].is_mine) {
-                return false;
+    if (!frontier.empty()) {
+        const int32_t thread_count = std::clamp<int32_t>(std::thread::hardware_concurrency(), 1, 16);
+        std::vector<std::vector<int32_t>> thread_next(thread_count);
+        bool done = false;
+
+        // runs on one thread once every thread has finished the current level
+        auto merge = [&]() noexcept {
+            frontier.clear();
+            for (std::vector<int32_t>& part : thread_next) {
+                frontier.insert(frontier.end(), part.begin(), part.end());
+                part.clear();
             }
-        }
+
+            order.insert(order.end(), frontier.begin(), frontier.end());
+            done = frontier.empty();
+        };
+
+        std::barrier sync(thread_count, merge);
+        auto work = [&](int32_t id) {
+            while (!done) {
+                const size_t begin = frontier.size() * id / thread_count;
+                const size_t end = frontier.size() * (id + 1) / thread_count;
+                for (size_t i = begin; i < end; i++)
+                    expand(frontier[i], thread_next[id]);
+                sync.arrive_and_wait();
+            }
+        };
+
+        std::vector<std::jthread> threads;
+        for (int32_t id = 1; id < thread_count; id++)
+            threads.emplace_back(work, id);
+        work(0);
     }
 
-    return true;
+    // every claimed square is in order, so clearing its words leaves the bitmap zeroed
+    // without touching the rest of a huge board
+    for (const int32_t index : order) {
+        m_visited[index / 64] = 0;
+        if (!m_squares[index].is_revealed)
+            modify(index).is_revealed = true;
+    }
+}
+
+bool GameBoard::didWin() const {
+    return dispatchDims(m_rows, m_cols, [this](auto dims) {
+        using Kernel = BoardKernel<decltype(dims)>;
+        return Kernel::didWin(dims, typename Kernel::Squares(m_squares.data(), m_squares.size()));
+    });
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 #include "model/data.h"
@@ -20,6 +21,19 @@ struct GameBoardSquare {
     bool operator!=(const GameBoardSquare& other) const = default;
 };
 
+// the value a square had before (or, once undone, after) an action touched it
+struct GameBoardChange {
+    GameBoardCoord coord;
+    GameBoardSquare square;
+};
+
+// one undoable reveal or mark. only the squares that the action touched are stored, so
+// the memory cost of the history is proportional to the number of changed squares
+struct GameBoardAction {
+    GameState state;
+    std::vector<GameBoardChange> changes;
+};
+
 class GameBoard {
 public:
     GameBoard() = default;
@@ -28,12 +42,51 @@ public:
     
     void reset(const GameSettings& settings);
     void mark(const GameBoardCoord& coord, GameState& state);
+    // generates the mines around coord first if this is the first reveal of the game
     void reveal(const GameBoardCoord& coord, GameState& state);
     void revealAdjacentDown(const GameBoardCoord& coord);    
     void revealAdjacentUp();
+
+    // both return false if there is nothing to undo/redo. the timer of the state is left
+    // untouched, since undoing a move does not turn back the clock
+    bool undo(GameState& state);
+    bool redo(GameState& state);
+    bool canUndo() const;
+    bool canRedo() const;
+
+    // the assists only look at numbers next to squares that a move changed. when a move
+    // leaves more of them than the budget allows, the rest waits here, and assist() works
+    // through the next budget of them, as part of the move that left them
+    void assist(GameState& state);
+    bool hasAssistWork() const;
+
+    // every square written since the last clear (or reset), including the visual-only
+    // changes of revealAdjacentDown/Up. a square may be listed more than once
+    const std::vector<GameBoardCoord>& changedSquares() const;
+    void clearChangedSquares();
     
-    // seed of -1 (wraps to UINT32_MAX) means a random seed
-    void generateMines(const GameBoardCoord& init);
+    // seed of -1 (wraps to UINT32_MAX) means a random seed. fails without placing
+    // anything if the mines do not fit around init (see isFeasible)
+    bool generateMines(const GameBoardCoord& init);
+    // places the mines before the game starts, either generated around anchor or copied
+    // from a bitmap (one bit per square, row-major, lowest bit first). the first reveal then
+    // keeps them instead of generating. fails if the mines do not fit around the anchor, or
+    // if the bitmap does not fit the board
+    bool preloadMines(const GameBoardCoord& anchor);
+    bool preloadMines(const std::vector<uint8_t>& bitmap);
+    std::vector<uint8_t> mineBitmap() const;
+    // what the player can see of every square, four bits each (revealed, marked, question
+    // and end reason, lowest first), two squares per byte in row-major order
+    std::vector<uint8_t> visibleBitmap() const;
+    // brings back a saved game on a freshly reset board: loads the mines like preloadMines
+    // and then the visible squares. there is no history to undo. fails if either bitmap
+    // does not fit the board
+    bool restore(const std::vector<uint8_t>& mines, const std::vector<uint8_t>& visible);
+
+    // results of the zero-region labelling, so nothing before the mines are generated.
+    // a square is opened by a region if it is in it or borders it
+    int32_t regionCount() const;
+    bool isOpenedByRegion(const GameBoardCoord& coord) const;
     void updateSettings(const GameSettings& new_settings);
 
     int32_t rowSize() const;
@@ -45,19 +98,88 @@ public:
     
 private:
     // this will reveal all neighboring squares that does not have mines adjacent to
-    // them, starting from the start coordinate. note that this function will not
-    // check if the row/col to start revealing at is a mine.
-    void floodfillImpl(const GameBoardCoord& start);
+    // them, starting from the start square. note that this function will not
+    // check if the square to start revealing at is a mine.
+    void floodfillImpl(int32_t start);
+    // same result as the sequential flood fill, but spreads large regions over all cores.
+    // only used on boards with at least s_parallel_min_squares squares
+    void floodfillParallelImpl(int32_t start);
     void generateMinesImpl(const GameBoardCoord& guarantee); 
     bool revealAdjacentImpl(const GameBoardCoord& coord);
+    // works through the assist work list within the budget, taking in the squares that
+    // the current action changed. returns true if it revealed anything
+    bool assistImpl(GameState& state);
+    bool assistSquare(int32_t center, GameState& state);
+    void queueAssist(int32_t index);
+    void clearAssist();
     void countAdjacent(); 
 
+    // the mine layout never changes after generation, so the connected regions of zero
+    // squares (and the numbered squares bordering them) are labelled once with union-find.
+    // revealing a zero square then opens its whole region in one pass over the output
+    // instead of running a bfs, as long as nothing in the region was revealed or marked
+    void labelRegions();
+    bool revealRegionImpl(int32_t label);
+
     bool didWin() const;
     void gameOverRevealMines(const GameBoardCoord& last_reveal);
     void gameWonMarkMines();
+
+    // every write to a square during an action goes through modify(), which saves the
+    // previous value of the square into the pending action
+    GameBoardSquare& modify(int32_t index);
+    void beginAction(const GameState& state);
+    void commitAction(GameState& state);
+    void applyAction(GameBoardAction& action, GameState& state, bool backwards);
+
+    // the squares are stored row-major with a one square halo of sentinels around the
+    // board, so that the eight neighbours of any board square are always valid offsets
+    int32_t index(int32_t row, int32_t col) const { return (row + 1) * m_stride + col + 1; }
+    GameBoardCoord coordOf(int32_t index) const { return { index / m_stride - 1, index % m_stride - 1 }; }
+    GameBoardSquare& at(int32_t row, int32_t col) { return m_squares[index(row, col)]; }
+    const GameBoardSquare& at(int32_t row, int32_t col) const { return m_squares[index(row, col)]; }
+    void initSquares();
     
 private:
+    static constexpr int32_t s_parallel_min_squares = 512 * 512;
+    static constexpr size_t s_parallel_min_frontier = 2048;
+
+    // a halo square counts as revealed so that flood fills and chord previews never enter
+    // it, has no mine so that it adds nothing to mine counts, and has a negative count so
+    // that it is neither a zero square nor a numbered square
+    static constexpr GameBoardSquare s_halo = { -1, false, true, false, false, false };
+
     GameSettings m_settings = GameSettings();
-    std::vector<std::vector<GameBoardSquare>> m_internal_copy = {}; // for revealAdjacent visual changes
-    std::vector<std::vector<GameBoardSquare>> m_board = {};
-};
\ No newline at end of file
+    std::vector<GameBoardChange> m_preview = {}; // for revealAdjacent visual changes
+    std::vector<GameBoardCoord> m_changed = {};
+
+    int32_t m_rows = 0, m_cols = 0, m_stride = 2;
+    std::vector<GameBoardSquare> m_squares = {};
+    std::vector<int32_t> m_queue = {}; // reused by the flood fill
+    // one bit per storage index, claimed atomically by the parallel flood fill and all
+    // zero again once it returns. plain words so that a board stays copyable
+    std::vector<uint64_t> m_visited = {};
+
+    // squares of region i are m_region_squares[m_region_offsets[i]..m_region_offsets[i + 1]]
+    // as storage indices, and likewise for the border. squares outside of any region have
+    // a label of -1. all empty until the mines are generated
+    std::vector<int32_t> m_labels = {};
+    std::vector<int32_t> m_region_offsets = {};
+    std::vector<int32_t> m_region_squares = {};
+    std::vector<int32_t> m_border_offsets = {};
+    std::vector<int32_t> m_border_squares = {};
+
+    bool m_is_preloaded = false;
+    bool m_recording = false;
+    GameBoardAction m_pending = {};
+    std::vector<GameBoardAction> m_undo = {};
+    std::vector<GameBoardAction> m_redo = {};
+
+    // numbers still to be looked at by the assists, as storage indices, with a flag per
+    // square so that none is listed twice. the changes of the pending action up to
+    // m_assist_fed have been taken into the list
+    std::vector<int32_t> m_assist = {};
+    std::vector<uint8_t> m_assist_queued = {};
+    size_t m_assist_fed = 0;
+    bool m_assist_revealed = false; // since the move, so the win check is still due
+};
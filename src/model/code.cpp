@@ -0,0 +1,170 @@
+#include <bit>
+#include <vector>
+#include <cstdint>
+
+#include <QString>
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include "model/code.h"
+#include "model/feasibility.h"
+
+namespace {
+
+    // layout of a version 1 board code, before base64:
+    // [0] version, [1] rows, [2] cols, [3..4] mines, [5] flags, [6..9] seed,
+    // [10] anchor row, [11] anchor col, [12..13] crc-16 of bytes 0..11
+    constexpr uint8_t s_code_version = 1;
+    constexpr int32_t s_code_payload = 12;
+    constexpr int32_t s_code_size = 14;
+    constexpr uint8_t s_no_anchor = 0xFF;
+
+    constexpr uint8_t s_flag_question = 1 << 0;
+    constexpr uint8_t s_flag_safe = 1 << 1;
+    constexpr uint8_t s_flag_clear = 1 << 2;
+    constexpr int32_t s_flag_generator_shift = 3;
+
+    // layout of a mine bitmap file: "MSMB", version, rows (2), cols (2), mines (2), bits
+    constexpr char s_bitmap_magic[4] = { 'M', 'S', 'M', 'B' };
+    constexpr uint8_t s_bitmap_version = 1;
+    constexpr int32_t s_bitmap_header = 11;
+    // the largest board a bitmap may load. the header allows 65535 x 65535, which overflows
+    // the int32 square indices of GameBoard
+    constexpr int64_t s_bitmap_max_squares = 8192 * 8192;
+
+    constexpr auto s_base64 = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+    void putLittle(QByteArray& out, uint32_t value, int32_t bytes) {
+        for (int32_t i = 0; i < bytes; i++)
+            out.append(char((value >> (8 * i)) & 0xFF));
+    }
+
+    uint32_t getLittle(const QByteArray& in, int32_t offset, int32_t bytes) {
+        uint32_t value = 0;
+        for (int32_t i = 0; i < bytes; i++)
+            value |= uint32_t(uint8_t(in[offset + i])) << (8 * i);
+        return value;
+    }
+
+}
+
+QString encodeBoardCode(const GameSettings& settings, const GameBoardCoord& anchor) {
+    // a truncated field would silently stand for another board. the anchor is inside the
+    // board, so it never reaches s_no_anchor
+    if (settings.row_size > 255 || settings.col_size > 255 || settings.num_mines > UINT16_MAX)
+        return QString();
+
+    uint8_t flags = uint8_t(settings.generator) << s_flag_generator_shift;
+    flags |= settings.is_question_enabled ? s_flag_question : 0;
+    flags |= settings.is_safe_first_move ? s_flag_safe : 0;
+    flags |= settings.is_clear_first_move ? s_flag_clear : 0;
+
+    QByteArray bytes;
+    bytes.reserve(s_code_size);
+    putLittle(bytes, s_code_version, 1);
+    putLittle(bytes, settings.row_size, 1);
+    putLittle(bytes, settings.col_size, 1);
+    putLittle(bytes, settings.num_mines, 2);
+    putLittle(bytes, flags, 1);
+    putLittle(bytes, settings.seed, 4);
+    putLittle(bytes, (anchor.row < 0) ? s_no_anchor : anchor.row, 1);
+    putLittle(bytes, (anchor.row < 0) ? s_no_anchor : anchor.col, 1);
+    putLittle(bytes, qChecksum(QByteArrayView(bytes)), 2);
+    return QString::fromLatin1(bytes.toBase64(s_base64));
+}
+
+bool decodeBoardCode(const QString& code, GameSettings& settings, GameBoardCoord& anchor) {
+    const auto decoded = QByteArray::fromBase64Encoding(
+        code.trimmed().toLatin1(), s_base64 | QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded || decoded->size() != s_code_size)
+        return false;
+
+    const QByteArray& bytes = *decoded;
+    if (getLittle(bytes, 0, 1) != s_code_version)
+        return false;
+    if (getLittle(bytes, s_code_payload, 2) != qChecksum(QByteArrayView(bytes).first(s_code_payload)))
+        return false;
+
+    const int32_t rows = getLittle(bytes, 1, 1);
+    const int32_t cols = getLittle(bytes, 2, 1);
+    const int32_t mines = getLittle(bytes, 3, 2);
+    const uint8_t flags = getLittle(bytes, 5, 1);
+    const uint8_t generator = flags >> s_flag_generator_shift;
+    if (!rows || !cols || mines >= rows * cols || generator > uint8_t(GameGenerator::Xoshiro))
+        return false;
+
+    const int32_t anchor_row = getLittle(bytes, 10, 1);
+    const int32_t anchor_col = getLittle(bytes, 11, 1);
+    if (anchor_row == s_no_anchor) {
+        anchor = { -1, -1 };
+    } else if (anchor_row < rows && anchor_col < cols) {
+        anchor = { anchor_row, anchor_col };
+    } else {
+        return false;
+    }
+
+    GameSettings result = settings;
+    result.row_size = rows;
+    result.col_size = cols;
+    result.num_mines = mines;
+    result.is_question_enabled = flags & s_flag_question;
+    result.is_safe_first_move = flags & s_flag_safe;
+    result.is_clear_first_move = flags & s_flag_clear;
+    result.generator = GameGenerator(generator);
+    result.seed = getLittle(bytes, 6, 4);
+    result.is_set_seed = true;
+
+    // the mines of a code have to fit around its first click, or around any first click
+    // if it has none yet
+    const BoardFeasibility feasibility = (anchor.row < 0) ? checkFeasibility(result) : checkFeasibility(result, anchor);
+    if (!feasibility.is_feasible)
+        return false;
+    settings = result;
+    return true;
+}
+
+QByteArray encodeMineBitmap(const GameSettings& settings, const std::vector<uint8_t>& bitmap) {
+    if (settings.row_size > UINT16_MAX || settings.col_size > UINT16_MAX || settings.num_mines > UINT16_MAX)
+        return QByteArray();
+
+    QByteArray data;
+    data.reserve(s_bitmap_header + bitmap.size());
+    data.append(s_bitmap_magic, sizeof(s_bitmap_magic));
+    putLittle(data, s_bitmap_version, 1);
+    putLittle(data, settings.row_size, 2);
+    putLittle(data, settings.col_size, 2);
+    putLittle(data, settings.num_mines, 2);
+    data.append(reinterpret_cast<const char*>(bitmap.data()), bitmap.size());
+    return data;
+}
+
+bool decodeMineBitmap(const QByteArray& data, GameSettings& settings, std::vector<uint8_t>& bitmap) {
+    if (data.size() < s_bitmap_header || !data.startsWith(QByteArrayView(s_bitmap_magic, sizeof(s_bitmap_magic))))
+        return false;
+    if (getLittle(data, 4, 1) != s_bitmap_version)
+        return false;
+
+    const int32_t rows = getLittle(data, 5, 2);
+    const int32_t cols = getLittle(data, 7, 2);
+    const int32_t mines = getLittle(data, 9, 2);
+    const int64_t squares = int64_t(rows) * cols;
+    if (!squares || squares > s_bitmap_max_squares || data.size() != s_bitmap_header + (squares + 7) / 8)
+        return false;
+
+    // the header count has to agree with the bits, or the mine counter would be wrong
+    bitmap.assign(data.begin() + s_bitmap_header, data.end());
+    const int32_t tail_bits = squares % 8;
+    if (tail_bits && (bitmap.back() >> tail_bits))
+        return false;
+
+    int32_t counted = 0;
+    for (uint8_t byte : bitmap)
+        counted += std::popcount(byte);
+    if (counted != mines)
+        return false;
+
+    settings.row_size = rows;
+    settings.col_size = cols;
+    settings.num_mines = mines;
+    return true;
+}
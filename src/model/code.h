@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <QString>
+#include <QByteArray>
+
+#include "model/data.h"
+#include "model/board.h"
+
+// a short, copyable code for one exact board. it holds everything that decides the mine
+// layout: the size, the mine count, the first move flags, the generator, the seed, and
+// the first click (the safe and clear zones are placed around it). an anchor with a
+// negative row means the game had not started, so the board is generated on first reveal.
+// rows and columns are stored in a byte and the mine count in two, so boards with more
+// than 255 rows or columns, or more than 65535 mines, have no code and get an empty string
+QString encodeBoardCode(const GameSettings& settings, const GameBoardCoord& anchor);
+// returns false if the code is malformed, fails its checksum, or is from an unknown version
+bool decodeBoardCode(const QString& code, GameSettings& settings, GameBoardCoord& anchor);
+
+// a pre-generated mine layout as file contents: a fixed header followed by one bit per
+// square in row-major order (see GameBoard::mineBitmap). the size and the mine count are
+// stored in two bytes each, so boards beyond that get an empty array
+QByteArray encodeMineBitmap(const GameSettings& settings, const std::vector<uint8_t>& bitmap);
+// only the size and mine count of settings are written. boards of more than
+// 8192 * 8192 squares are rejected
+bool decodeMineBitmap(const QByteArray& data, GameSettings& settings, std::vector<uint8_t>& bitmap);
@@ -0,0 +1,169 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "model/compressed.h"
+
+CompressedBoard::CompressedBoard(const GameBoard& board) {
+    assign(board);
+}
+
+void CompressedBoard::assign(const GameBoard& board) {
+    // an empty board has no square to take the uniform value of a tile from
+    m_rows = std::max(board.rowSize(), 0);
+    m_cols = std::max(board.colSize(), 0);
+    if (!m_rows || !m_cols) {
+        m_rows = m_cols = 0;
+        m_tile_rows = m_tile_cols = 0;
+        m_mines.clear();
+        m_tiles.clear();
+        m_expanded_count = 0;
+        return;
+    }
+
+    m_tile_rows = (m_rows + tile_size - 1) / tile_size;
+    m_tile_cols = (m_cols + tile_size - 1) / tile_size;
+    m_mines.assign((size_t(m_rows) * m_cols + 63) / 64, 0);
+    m_tiles.assign(m_tile_rows * m_tile_cols, Tile());
+    m_expanded_count = 0;
+
+    for (int32_t tile_row = 0; tile_row < m_tile_rows; tile_row++) {
+        for (int32_t tile_col = 0; tile_col < m_tile_cols; tile_col++) {
+            const int32_t start_row = tile_row * tile_size;
+            const int32_t start_col = tile_col * tile_size;
+            const int32_t end_row = std::min(start_row + tile_size, m_rows);
+            const int32_t end_col = std::min(start_col + tile_size, m_cols);
+            Tile& tile = m_tiles[tile_row * m_tile_cols + tile_col];
+            tile.uniform = visibleState(board.getSquare({ start_row, start_col }));
+
+            // the mines never decide whether a tile is uniform
+            bool is_uniform = true;
+            for (int32_t i = start_row; i < end_row; i++) {
+                for (int32_t j = start_col; j < end_col; j++) {
+                    const GameBoardSquare& square = board.getSquare({ i, j });
+                    if (square.is_mine)
+                        setMine(i, j, true);
+                    is_uniform = is_uniform && visibleState(square) == tile.uniform;
+                }
+            }
+
+            if (is_uniform)
+                continue;
+            expandTile(tile);
+            TileStorage& storage = m_expanded[tile.expanded];
+            for (int32_t i = start_row; i < end_row; i++) {
+                for (int32_t j = start_col; j < end_col; j++) {
+                    setState(storage, i, j, visibleState(board.getSquare({ i, j })));
+                }
+            }
+        }
+    }
+}
+
+void CompressedBoard::decompress(GameBoard& board) const {
+    assert(board.rowSize() == m_rows && board.colSize() == m_cols);
+    for (int32_t i = 0; i < m_rows; i++) {
+        for (int32_t j = 0; j < m_cols; j++) {
+            board.getSquare({ i, j }) = getSquare({ i, j });
+        }
+    }
+}
+
+void CompressedBoard::setSquare(const GameBoardCoord& coord, const GameBoardSquare& square) {
+    setMine(coord.row, coord.col, square.is_mine);
+    const uint8_t state = visibleState(square);
+    Tile& tile = tileAt(coord.row, coord.col);
+    if (tile.expanded < 0) {
+        if (tile.uniform == state)
+            return;
+        expandTile(tile);
+    }
+
+    setState(m_expanded[tile.expanded], coord.row, coord.col, state);
+}
+
+int32_t CompressedBoard::rowSize() const {
+    return m_rows;
+}
+
+int32_t CompressedBoard::colSize() const {
+    return m_cols;
+}
+
+GameBoardSquare CompressedBoard::getSquare(const GameBoardCoord& get_coord) const {
+    const Tile& tile = tileAt(get_coord.row, get_coord.col);
+    uint8_t state = tile.uniform;
+    if (tile.expanded >= 0)
+        state = getState(m_expanded[tile.expanded], get_coord.row, get_coord.col);
+
+    GameBoardSquare square;
+    square.is_mine = isMine(get_coord.row, get_coord.col);
+    square.is_revealed = state & s_revealed;
+    square.is_marked = state & s_marked;
+    square.is_question = state & s_question;
+    square.is_end_reason = state & s_end_reason;
+    for (int32_t i = std::max(get_coord.row - 1, 0); i <= std::min(get_coord.row + 1, m_rows - 1); i++) {
+        for (int32_t j = std::max(get_coord.col - 1, 0); j <= std::min(get_coord.col + 1, m_cols - 1); j++) {
+            if (i != get_coord.row || j != get_coord.col)
+                square.adjacent_mines += isMine(i, j);
+        }
+    }
+    return square;
+}
+
+size_t CompressedBoard::expandedTiles() const {
+    return m_expanded_count;
+}
+
+size_t CompressedBoard::memoryUsage() const {
+    return m_mines.size() * sizeof(uint64_t) + m_tiles.size() * sizeof(Tile) + m_expanded_count * sizeof(TileStorage);
+}
+
+uint8_t CompressedBoard::visibleState(const GameBoardSquare& square) {
+    uint8_t state = 0;
+    state |= square.is_revealed ? s_revealed : 0;
+    state |= square.is_marked ? s_marked : 0;
+    state |= square.is_question ? s_question : 0;
+    state |= square.is_end_reason ? s_end_reason : 0;
+    return state;
+}
+
+uint8_t CompressedBoard::getState(const TileStorage& storage, int32_t row, int32_t col) {
+    const int32_t offset = (row % tile_size) * tile_size + col % tile_size;
+    return (storage[offset / 2] >> (4 * (offset % 2))) & 0xF;
+}
+
+void CompressedBoard::setState(TileStorage& storage, int32_t row, int32_t col, uint8_t state) {
+    const int32_t offset = (row % tile_size) * tile_size + col % tile_size;
+    const int32_t shift = 4 * (offset % 2);
+    storage[offset / 2] = (storage[offset / 2] & ~(0xF << shift)) | (state << shift);
+}
+
+bool CompressedBoard::isMine(int32_t row, int32_t col) const {
+    const size_t index = size_t(row) * m_cols + col;
+    return (m_mines[index / 64] >> (index % 64)) & 1;
+}
+
+void CompressedBoard::setMine(int32_t row, int32_t col, bool is_mine) {
+    const size_t index = size_t(row) * m_cols + col;
+    const uint64_t bit = uint64_t(1) << (index % 64);
+    m_mines[index / 64] = is_mine ? (m_mines[index / 64] | bit) : (m_mines[index / 64] & ~bit);
+}
+
+CompressedBoard::Tile& CompressedBoard::tileAt(int32_t row, int32_t col) {
+    return m_tiles[(row / tile_size) * m_tile_cols + col / tile_size];
+}
+
+const CompressedBoard::Tile& CompressedBoard::tileAt(int32_t row, int32_t col) const {
+    return m_tiles[(row / tile_size) * m_tile_cols + col / tile_size];
+}
+
+void CompressedBoard::expandTile(Tile& tile) {
+    // expanded storage is never released, only recycled by the next assign(), so that
+    // re-compressing boards of the same size does not touch the allocator
+    if (m_expanded_count == m_expanded.size())
+        m_expanded.emplace_back();
+    tile.expanded = m_expanded_count++;
+    m_expanded[tile.expanded].fill(tile.uniform | (tile.uniform << 4));
+}
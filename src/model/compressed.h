@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "model/board.h"
+
+// a read-mostly copy of a game board split into square tiles. the layout (where the mines
+// are) is kept apart in a bitmap, and the tiles only hold what play changes: revealed,
+// marked, question and end reason. a tile whose squares all look the same (e.g. untouched
+// squares, whatever they hide, or a settled region of revealed squares) is stored as a
+// single value, and only tiles that contain differing squares are expanded into full
+// storage. on large boards this makes keeping a copy around an order of magnitude cheaper
+// than copying the whole board, while getSquare() stays a tile lookup plus an index and a
+// count of the mines around it.
+class CompressedBoard {
+public:
+    static constexpr int32_t tile_size = 16;
+
+    CompressedBoard() = default;
+    explicit CompressedBoard(const GameBoard& board);
+
+    // rebuilds the tiles from a board. storage of previously expanded tiles is reused, so
+    // reassigning a board of the same size does not allocate
+    void assign(const GameBoard& board);
+    // writes every square back into a board of the same size
+    void decompress(GameBoard& board) const;
+    // expands the containing tile if the new square breaks its uniformity
+    void setSquare(const GameBoardCoord& coord, const GameBoardSquare& square);
+
+    int32_t rowSize() const;
+    int32_t colSize() const;
+
+    // by value, since setSquare() may move the storage of every expanded tile. the
+    // adjacent mines are counted from the layout, as GameBoard keeps them
+    GameBoardSquare getSquare(const GameBoardCoord& get_coord) const;
+    size_t expandedTiles() const;
+    size_t memoryUsage() const;
+
+private:
+    // the per-play state of a square, one bit per flag. it fits in four bits, so an
+    // expanded tile packs two squares per byte
+    static constexpr uint8_t s_revealed = 1 << 0;
+    static constexpr uint8_t s_marked = 1 << 1;
+    static constexpr uint8_t s_question = 1 << 2;
+    static constexpr uint8_t s_end_reason = 1 << 3;
+
+    using TileStorage = std::array<uint8_t, tile_size * tile_size / 2>;
+
+    struct Tile {
+        uint8_t uniform = 0;
+        int32_t expanded = -1; // index into m_expanded, or -1 if the tile is uniform
+    };
+
+    static uint8_t visibleState(const GameBoardSquare& square);
+    static uint8_t getState(const TileStorage& storage, int32_t row, int32_t col);
+    static void setState(TileStorage& storage, int32_t row, int32_t col, uint8_t state);
+    bool isMine(int32_t row, int32_t col) const;
+    void setMine(int32_t row, int32_t col, bool is_mine);
+    Tile& tileAt(int32_t row, int32_t col);
+    const Tile& tileAt(int32_t row, int32_t col) const;
+    void expandTile(Tile& tile);
+
+private:
+    int32_t m_rows = 0, m_cols = 0;
+    int32_t m_tile_rows = 0, m_tile_cols = 0;
+    std::vector<uint64_t> m_mines = {}; // one bit per square, row-major
+    std::vector<Tile> m_tiles = {};
+    std::vector<TileStorage> m_expanded = {};
+    size_t m_expanded_count = 0;
+};
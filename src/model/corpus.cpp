@@ -0,0 +1,113 @@
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+#include "model/corpus.h"
+#include "model/analysis.h"
+
+namespace {
+
+    constexpr char s_magic[4] = { 'M', 'S', 'C', 'P' };
+    constexpr uint32_t s_version = 1;
+
+}
+
+bool CorpusWriter::open(const QString& path, const GameSettings& settings) {
+    // anchors are stored in a byte each, and 3bv and openings (at most one per square) in
+    // two bytes each
+    if (settings.row_size <= 0 || settings.col_size <= 0 || settings.row_size > 255 || settings.col_size > 255
+        || settings.row_size * settings.col_size > UINT16_MAX)
+        return false;
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const uint32_t bitmap_size = (settings.row_size * settings.col_size + 7) / 8;
+    m_header = {};
+    std::memcpy(m_header.magic, s_magic, sizeof(s_magic));
+    m_header.version = s_version;
+    m_header.row_size = settings.row_size;
+    m_header.col_size = settings.col_size;
+    m_header.num_mines = settings.num_mines;
+    m_header.flags = uint8_t(settings.is_safe_first_move) | uint8_t(settings.is_clear_first_move) << 1;
+    m_header.generator = uint8_t(settings.generator);
+    m_header.record_size = (sizeof(CorpusRecord) + bitmap_size + 7) / 8 * 8;
+    m_header.bitmap_size = bitmap_size;
+    m_header.count = 0;
+
+    m_record.fill(0, m_header.record_size);
+    return m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header)) == sizeof(m_header);
+}
+
+bool CorpusWriter::append(const GameBoard& board, const GameBoardCoord& anchor) {
+    // a board of another size would not fill the record the header promises
+    if (board.rowSize() != m_header.row_size || board.colSize() != m_header.col_size)
+        return false;
+
+    const BoardMetrics metrics = measureBoard(board);
+    const std::vector<uint8_t> bitmap = board.mineBitmap();
+
+    CorpusRecord record = {};
+    record.seed = board.getSeed();
+    record.anchor_row = anchor.row;
+    record.anchor_col = anchor.col;
+    record.bbbv = metrics.bbbv;
+    record.openings = metrics.openings;
+
+    // the buffer is reused, and the padding after the bitmap is never written to
+    std::memcpy(m_record.data(), &record, sizeof(record));
+    std::memcpy(m_record.data() + sizeof(record), bitmap.data(), bitmap.size());
+    if (m_file.write(m_record) != m_record.size())
+        return false;
+    m_header.count++;
+    return true;
+}
+
+bool CorpusWriter::close() {
+    const bool ok = m_file.seek(0)
+        && m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header)) == sizeof(m_header);
+    m_file.close();
+    return ok;
+}
+
+CorpusReader::~CorpusReader() {
+    close();
+}
+
+bool CorpusReader::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(CorpusHeader)))
+        return false;
+
+    m_data = m_file.map(0, m_file.size());
+    if (!m_data)
+        return false;
+
+    // a truncated file (e.g. a writer that never closed) is rejected instead of read past.
+    // the count is compared by division, since a corrupt one could wrap a multiplication,
+    // and records are padded to 8 bytes, which keeps every record aligned in the mapping
+    const CorpusHeader& head = header();
+    const uint64_t record_bytes = uint64_t(m_file.size()) - sizeof(CorpusHeader);
+    if (std::memcmp(head.magic, s_magic, sizeof(s_magic)) || head.version != s_version
+        || head.bitmap_size != (uint32_t(head.row_size) * head.col_size + 7) / 8
+        || head.record_size < sizeof(CorpusRecord) + head.bitmap_size || head.record_size % 8
+        || head.count > record_bytes / head.record_size) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void CorpusReader::close() {
+    if (m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_file.close();
+}
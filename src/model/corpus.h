@@ -0,0 +1,85 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+#include "model/data.h"
+#include "model/board.h"
+
+// a corpus file holds many generated layouts of one board configuration as fixed size
+// records, so that the n-th board is at a computed offset and the file can be mapped and
+// read in place. the structs below are the on-disk layout; the format is little endian,
+// which is also what lets the reader use the mapped bytes directly
+static_assert(std::endian::native == std::endian::little, "corpus files are read in place");
+
+struct CorpusHeader {
+    char magic[4]; // "MSCP"
+    uint32_t version;
+    uint16_t row_size, col_size;
+    uint16_t num_mines;
+    uint8_t flags; // bit 0 safe first move, bit 1 clear first move
+    uint8_t generator;
+    uint32_t record_size; // bytes per record, a multiple of 8
+    uint32_t bitmap_size; // bytes of mines per record
+    uint64_t count;
+    uint8_t reserved[32];
+};
+
+// the metadata of one layout, followed by its mines as a bitmap (one bit per square,
+// row-major, see GameBoard::mineBitmap) and padding up to the record size
+struct CorpusRecord {
+    uint32_t seed;
+    uint8_t anchor_row, anchor_col; // the first click the layout was generated around
+    uint16_t bbbv;
+    uint16_t openings;
+    uint16_t reserved;
+
+    const uint8_t* mines() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+    bool isMine(int32_t square) const { return (mines()[square / 8] >> (square % 8)) & 1; }
+};
+
+static_assert(sizeof(CorpusHeader) == 64);
+static_assert(sizeof(CorpusRecord) == 12);
+
+class CorpusWriter {
+public:
+    // the first move flags, generator and size of settings are stored in the header;
+    // every appended board has to match them. fails for boards whose records cannot hold
+    // their anchor or metrics: more than 255 rows or columns, or more than 65535 squares
+    bool open(const QString& path, const GameSettings& settings);
+    // fails for a board of another size than the header, and if the record could not be
+    // written (e.g. the disk is full). in the latter case the record is not counted, but
+    // the file may hold part of it, so the corpus should be given up
+    bool append(const GameBoard& board, const GameBoardCoord& anchor);
+    // writes the final record count into the header
+    bool close();
+
+private:
+    QFile m_file;
+    CorpusHeader m_header = {};
+    QByteArray m_record = {};
+};
+
+// maps the whole file and hands out references into the mapping: reading a record neither
+// copies nor allocates. the records stay valid until the reader is closed or destroyed
+class CorpusReader {
+public:
+    ~CorpusReader();
+
+    bool open(const QString& path);
+    void close();
+
+    const CorpusHeader& header() const { return *reinterpret_cast<const CorpusHeader*>(m_data); }
+    uint64_t size() const { return header().count; }
+    const CorpusRecord& operator[](uint64_t index) const {
+        return *reinterpret_cast<const CorpusRecord*>(m_data + sizeof(CorpusHeader) + index * header().record_size);
+    }
+
+private:
+    QFile m_file;
+    const uchar* m_data = nullptr;
+};
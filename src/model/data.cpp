@@ -1,3 +1,6 @@
+#include <cstdint>
+#include <algorithm>
+
 #include "model/data.h"
 
 #include <QStandardPaths>
@@ -6,3 +9,34 @@
 GameSettings loadSettings() {
     
 }
+
+namespace {
+
+    void recordInto(int32_t& played, int32_t& won, double& ratio, int64_t& best_time, const GameState& state) {
+        played++;
+        if (state.won) {
+            won++;
+            if (best_time < 0 || state.timer < best_time)
+                best_time = state.timer;
+        }
+        ratio = double(won) / played;
+    }
+
+}
+
+void GameStatistics::record(const GameSettings& settings, const GameState& state) {
+    if (!state.won && !state.lost)
+        return;
+
+    play_time += std::max<int64_t>(state.timer, 0);
+    recordInto(total_played, total_won, total_ratio, best_time_all, state);
+    const auto is_board = [&settings](int32_t rows, int32_t cols, int32_t mines) {
+        return settings.row_size == rows && settings.col_size == cols && settings.num_mines == mines;
+    };
+    if (is_board(9, 9, 10))
+        recordInto(easy_played, easy_won, easy_ratio, best_time_easy, state);
+    else if (is_board(16, 16, 40))
+        recordInto(intermediate_played, intermediate_won, intermediate_ratio, best_time_intermediate, state);
+    else if (is_board(16, 30, 99))
+        recordInto(advanced_played, advanced_won, advanced_ratio, best_time_advanced, state);
+}
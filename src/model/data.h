@@ -8,11 +8,21 @@ struct GameState {
     bool lost = false;
     bool revealing_mine = false;
     bool is_first_reveal = true; 
-    int mines = -1, timer = -1;
+    int mines = -1;
+    int64_t timer = -1; // milliseconds of play
+    int clicks = 0; // reveals, chords and marks that did something
+    int first_row = -1, first_col = -1; // the square the mines were generated around
     bool operator==(const GameState& other) const = default;
     bool operator!=(const GameState& other) const = default;
 };
 
+// the random number generator that maps a seed to a mine layout. mt19937 is what seeds
+// have always meant, so it stays the default; xoshiro is cheaper to seed and draw from
+enum class GameGenerator : uint8_t {
+    Mt19937 = 0,
+    Xoshiro = 1
+};
+
 struct GameSettings {
     int32_t row_size = 9;
     int32_t col_size = 9; 
@@ -22,32 +32,45 @@ struct GameSettings {
     bool is_safe_first_move = true;
     bool is_clear_first_move = false;
     bool is_set_seed = false;
+    GameGenerator generator = GameGenerator::Mt19937;
+    // assists that run after every reveal and mark: auto chord opens the squares around a
+    // number once all of its mines are flagged, auto flag flags the squares around a
+    // number that can only be mines. they look at most assist_budget numbers per move,
+    // and the rest is left for the next move (see GameBoard::assist)
+    bool is_auto_chord = false;
+    bool is_auto_flag = false;
+    int32_t assist_budget = 4096;
 };
 
-// TODO: Implement
+// what the games played so far add up to. times are the milliseconds of GameState::timer,
+// so best times keep the resolution of the game clock; -1 means no game was won yet. the
+// difficulties are the classic boards (9x9 with 10 mines, 16x16 with 40 and 16x30 with 99)
 struct GameStatistics {
-    double best_time_all;
-    double best_time_easy;
-    double best_time_intermediate;
-    double best_time_advanced;
+    int64_t best_time_all = -1;
+    int64_t best_time_easy = -1;
+    int64_t best_time_intermediate = -1;
+    int64_t best_time_advanced = -1;
+
+    int32_t total_played = 0;
+    int32_t total_won = 0;
+    double total_ratio = 0;
 
-    int32_t total_played;
-    int32_t total_won;
-    double total_ratio;
+    int32_t easy_played = 0;
+    int32_t easy_won = 0;
+    double easy_ratio = 0;
 
-    int32_t easy_played;
-    int32_t easy_won;
-    double easy_ratio;
+    int32_t intermediate_played = 0;
+    int32_t intermediate_won = 0;
+    double intermediate_ratio = 0;
 
-    int32_t intermediate_played;
-    int32_t intermediate_won;
-    double intermediate_ratio;
+    int32_t advanced_played = 0;
+    int32_t advanced_won = 0;
+    double advanced_ratio = 0;
 
-    int32_t advanced_played;
-    int32_t advanced_won;
-    double advanced_ratio;
+    int64_t play_time = 0;
 
-    double play_time;
+    // counts a game that has ended, won or lost
+    void record(const GameSettings& settings, const GameState& state);
 };
 
 GameSettings loadSettings();
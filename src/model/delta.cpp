@@ -0,0 +1,166 @@
+#include <vector>
+#include <cstdint>
+
+#include <QByteArray>
+
+#include "model/delta.h"
+
+namespace {
+
+    constexpr int32_t s_header_size = 11;
+    constexpr int32_t s_keyframe_header_size = s_header_size + 2;
+
+    constexpr uint8_t s_flag_won = 1 << 0;
+    constexpr uint8_t s_flag_lost = 1 << 1;
+
+    void putLittle(QByteArray& out, uint32_t value, int32_t bytes) {
+        for (int32_t i = 0; i < bytes; i++)
+            out.append(char((value >> (8 * i)) & 0xFF));
+    }
+
+    uint32_t getLittle(const QByteArray& in, int32_t offset, int32_t bytes) {
+        uint32_t value = 0;
+        for (int32_t i = 0; i < bytes; i++)
+            value |= uint32_t(uint8_t(in[offset + i])) << (8 * i);
+        return value;
+    }
+
+    // seven bits per byte, lowest first; the high bit says that more bytes follow
+    void putVarint(QByteArray& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.append(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.append(char(value));
+    }
+
+    bool getVarint(const QByteArray& in, int32_t& offset, uint32_t& value) {
+        value = 0;
+        for (int32_t shift = 0; shift < 32; shift += 7) {
+            if (offset >= in.size())
+                return false;
+            const uint8_t byte = in[offset++];
+            value |= uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    void putHeader(QByteArray& out, uint32_t board, const SpectatorBoard& state) {
+        uint8_t flags = 0;
+        flags |= state.won ? s_flag_won : 0;
+        flags |= state.lost ? s_flag_lost : 0;
+        putLittle(out, board, 4);
+        putLittle(out, state.sequence, 4);
+        putLittle(out, flags, 1);
+        putLittle(out, state.mines, 2);
+    }
+
+    void getHeader(const QByteArray& in, SpectatorBoard& board) {
+        const uint8_t flags = getLittle(in, 8, 1);
+        board.sequence = getLittle(in, 4, 4);
+        board.won = flags & s_flag_won;
+        board.lost = flags & s_flag_lost;
+        board.mines = int16_t(getLittle(in, 9, 2));
+    }
+
+    // packs count tiles, where tile(i) is the i-th
+    template <typename Tile>
+    void putTiles(QByteArray& out, int32_t count, Tile tile) {
+        for (int32_t i = 0; i < count; i += 2) {
+            const uint8_t high = (i + 1 < count) ? tile(i + 1) : 0;
+            out.append(char(tile(i) | (high << 4)));
+        }
+    }
+
+}
+
+QByteArray encodeSpectatorKeyframe(uint32_t board, const SpectatorBoard& state) {
+    const int32_t count = state.row_size * state.col_size;
+    QByteArray out = beginRaceFrame(RaceMessage::Keyframe);
+    out.reserve(out.size() + s_keyframe_header_size + (count + 1) / 2);
+    putHeader(out, board, state);
+    putLittle(out, state.row_size, 1);
+    putLittle(out, state.col_size, 1);
+    putTiles(out, count, [&](int32_t i) { return state.tiles[i]; });
+    endRaceFrame(out); // at most 255 * 255 / 2 bytes of tiles
+    return out;
+}
+
+QByteArray encodeSpectatorDelta(uint32_t board, const SpectatorBoard& state, const std::vector<SpectatorChange>& changes) {
+    QByteArray out = beginRaceFrame(RaceMessage::Delta);
+    putHeader(out, board, state);
+
+    // a run is a stretch of consecutive changed squares. within a row of a flood fill
+    // most changes are neighbours, so runs are long and the skips short
+    int32_t position = 0; // the square after the previous run
+    for (size_t begin = 0; begin < changes.size();) {
+        size_t end = begin + 1;
+        while (end < changes.size() && changes[end].square == changes[end - 1].square + 1)
+            end++;
+
+        putVarint(out, changes[begin].square - position);
+        putVarint(out, end - begin);
+        putTiles(out, end - begin, [&](int32_t i) { return changes[begin + i].tile; });
+        position = changes[end - 1].square + 1;
+        begin = end;
+    }
+
+    // scattered changes on a huge board can cost more than the board itself
+    if (!endRaceFrame(out) || out.size() > qsizetype(s_keyframe_header_size + (state.tiles.size() + 1) / 2))
+        return encodeSpectatorKeyframe(board, state);
+    return out;
+}
+
+bool peekSpectatorBoard(const QByteArray& payload, uint32_t& board) {
+    if (payload.size() < s_header_size)
+        return false;
+    board = getLittle(payload, 0, 4);
+    return true;
+}
+
+bool applySpectatorFrame(RaceMessage type, const QByteArray& payload, SpectatorBoard& board) {
+    if (type == RaceMessage::Keyframe) {
+        if (payload.size() < s_keyframe_header_size)
+            return false;
+        const int32_t rows = getLittle(payload, s_header_size, 1);
+        const int32_t cols = getLittle(payload, s_header_size + 1, 1);
+        if (payload.size() != s_keyframe_header_size + (rows * cols + 1) / 2)
+            return false;
+
+        getHeader(payload, board);
+        board.row_size = rows;
+        board.col_size = cols;
+        board.tiles.resize(rows * cols);
+        for (int32_t i = 0; i < rows * cols; i++)
+            board.tiles[i] = (uint8_t(payload[s_keyframe_header_size + i / 2]) >> (4 * (i % 2))) & 0xF;
+        return true;
+    }
+
+    if (type != RaceMessage::Delta || payload.size() < s_header_size || board.tiles.empty())
+        return false;
+    if (getLittle(payload, 4, 4) != board.sequence + 1)
+        return false;
+
+    // the runs are checked before anything is applied, so a bad delta changes nothing
+    for (int32_t pass = 0; pass < 2; pass++) {
+        int32_t offset = s_header_size;
+        uint64_t position = 0; // wide enough that no skip can wrap it
+        while (offset < payload.size()) {
+            uint32_t skip = 0, length = 0;
+            if (!getVarint(payload, offset, skip) || !getVarint(payload, offset, length) || !length)
+                return false;
+            position += skip;
+            if (position + length > board.tiles.size() || offset + (length + 1) / 2 > uint32_t(payload.size()))
+                return false;
+            for (uint32_t i = 0; pass && i < length; i++)
+                board.tiles[position + i] = (uint8_t(payload[offset + i / 2]) >> (4 * (i % 2))) & 0xF;
+            offset += (length + 1) / 2;
+            position += length;
+        }
+    }
+
+    getHeader(payload, board);
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <QByteArray>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/protocol.h"
+#include "model/tile.h"
+
+// one changed square of a delta, by row-major index. tiles are BoardTile values
+struct SpectatorChange {
+    int32_t square;
+    uint8_t tile;
+};
+
+// a spectator's copy of one board
+struct SpectatorBoard {
+    int32_t row_size = 0, col_size = 0;
+    uint32_t sequence = 0;
+    bool won = false;
+    bool lost = false;
+    int32_t mines = 0;
+    std::vector<uint8_t> tiles = {}; // row-major, empty until the first keyframe
+};
+
+// spectator frames use the race framing (see model/protocol.h). both start with the same
+// header: u32 board, u32 sequence, u8 flags (won, lost), u16 mines
+//
+//   keyframe  header, u8 rows, u8 cols, every tile
+//   delta     header, then runs of changed squares: varint squares skipped since the
+//             previous run, varint run length, the tiles of the run
+//
+// tiles are packed two per byte, low nibble first; a run or keyframe with an odd number of
+// tiles leaves the last high nibble empty
+QByteArray encodeSpectatorKeyframe(uint32_t board, const SpectatorBoard& state);
+// changes have to be sorted by square and free of duplicates
+QByteArray encodeSpectatorDelta(uint32_t board, const SpectatorBoard& state, const std::vector<SpectatorChange>& changes);
+
+// reads the board a keyframe or delta payload is for, so the caller can find its copy
+bool peekSpectatorBoard(const QByteArray& payload, uint32_t& board);
+// returns false if the payload is malformed, or if it is a delta that does not directly
+// follow what the board has seen; the board then has to wait for the next keyframe
+bool applySpectatorFrame(RaceMessage type, const QByteArray& payload, SpectatorBoard& board);
@@ -0,0 +1,61 @@
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "model/feasibility.h"
+
+namespace {
+
+    // the square whose clipped 3x3 neighbourhood is the largest
+    GameBoardCoord worstAnchor(const GameSettings& settings) {
+        return { std::min(1, settings.row_size - 1), std::min(1, settings.col_size - 1) };
+    }
+
+}
+
+int32_t reservedSquares(const GameSettings& settings, const GameBoardCoord& anchor) {
+    if (settings.is_clear_first_move) {
+        const int32_t rows = std::min(anchor.row + 1, settings.row_size - 1) - std::max(anchor.row - 1, 0) + 1;
+        const int32_t cols = std::min(anchor.col + 1, settings.col_size - 1) - std::max(anchor.col - 1, 0) + 1;
+        return rows * cols;
+    }
+    return settings.is_safe_first_move ? 1 : 0;
+}
+
+bool isFeasible(const GameSettings& settings, const GameBoardCoord& anchor) {
+    if (settings.row_size <= 0 || settings.col_size <= 0 || settings.num_mines < 0)
+        return false;
+    const int32_t squares = settings.row_size * settings.col_size;
+    return settings.num_mines <= squares - std::max(reservedSquares(settings, anchor), 1);
+}
+
+BoardFeasibility checkFeasibility(const GameSettings& settings, const GameBoardCoord& anchor) {
+    BoardFeasibility result;
+    if (!isFeasible(settings, anchor))
+        return result;
+
+    const int32_t squares = settings.row_size * settings.col_size;
+    result.allowed = squares - reservedSquares(settings, anchor);
+    result.is_feasible = true;
+
+    // with i mines placed, a draw is kept with probability (allowed - i) / squares, so
+    // the draws of each mine are geometric. the layouts are the binomial coefficient,
+    // built up in the same loop since std::lgamma writes the global signgam and this is
+    // called from the board worker, the estimator's pool and the gui at once
+    const int32_t mines = settings.num_mines;
+    result.log10_layouts = 0;
+    for (int32_t i = 0; i < mines; i++) {
+        result.log10_layouts += std::log10(double(result.allowed - i) / (i + 1));
+        result.expected_draws += double(squares) / (result.allowed - i);
+    }
+    return result;
+}
+
+BoardFeasibility checkFeasibility(const GameSettings& settings) {
+    return checkFeasibility(settings, worstAnchor(settings));
+}
+
+int32_t maxFeasibleMines(const GameSettings& settings) {
+    const int32_t squares = settings.row_size * settings.col_size;
+    return std::max(squares - std::max(reservedSquares(settings, worstAnchor(settings)), 1), 0);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include "model/data.h"
+#include "model/board.h"
+
+// whether mines can be generated for a configuration, and what it costs. generation draws
+// random squares and throws away the ones that are taken or that the first move keeps
+// free, so a configuration with fewer allowed squares than mines would draw forever, and
+// one with barely enough draws many times per mine
+struct BoardFeasibility {
+    bool is_feasible = false;
+    int32_t allowed = 0; // squares that may hold a mine
+    // the number of distinct layouts, C(allowed, mines), as a base 10 logarithm since it
+    // overflows every integer type on all but the smallest boards. -1 if there are none
+    double log10_layouts = -1;
+    // the expected number of random draws to place every mine. 0 if there are none
+    double expected_draws = 0;
+};
+
+// the squares the first move policy keeps free of mines around anchor, clipped to the board
+int32_t reservedSquares(const GameSettings& settings, const GameBoardCoord& anchor);
+// only the count comparison of checkFeasibility, cheap enough for every generated board.
+// a board needs at least one square without a mine to be playable, whatever the policy
+bool isFeasible(const GameSettings& settings, const GameBoardCoord& anchor);
+// for a first click at anchor
+BoardFeasibility checkFeasibility(const GameSettings& settings, const GameBoardCoord& anchor);
+// for the first click that keeps the most squares free, so the result holds wherever the
+// player starts
+BoardFeasibility checkFeasibility(const GameSettings& settings);
+// the most mines that every first click leaves room for, with at least one free square
+int32_t maxFeasibleMines(const GameSettings& settings);
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "model/board.h"
+
+// board dimensions that are known at compile time. kernels instantiated with these get
+// constant loop bounds, a constant row stride and a constant neighbour offset table, and
+// the squares are viewed through a span with a static extent, so the compiler can fold
+// away the index arithmetic and bounds of the standard preset boards. the storage includes
+// the one square sentinel halo of the game board, hence the extra two rows and columns
+template <int32_t Rows, int32_t Cols>
+struct FixedDims {
+    static constexpr size_t extent = (Rows + 2) * (Cols + 2);
+    static constexpr int32_t rows() { return Rows; }
+    static constexpr int32_t cols() { return Cols; }
+    static constexpr int32_t stride() { return Cols + 2; }
+};
+
+// the fallback for every other board size
+struct DynamicDims {
+    static constexpr size_t extent = std::dynamic_extent;
+    int32_t row_count, col_count;
+    constexpr int32_t rows() const { return row_count; }
+    constexpr int32_t cols() const { return col_count; }
+    constexpr int32_t stride() const { return col_count + 2; }
+};
+
+// calls func with the compile time dimensions of the beginner, intermediate and expert
+// presets if the board has one of those sizes, and with runtime dimensions otherwise
+template <typename Func>
+decltype(auto) dispatchDims(int32_t rows, int32_t cols, Func&& func) {
+    if (rows == 9 && cols == 9)
+        return func(FixedDims<9, 9>());
+    if (rows == 12 && cols == 20)
+        return func(FixedDims<12, 20>());
+    if (rows == 16 && cols == 30)
+        return func(FixedDims<16, 30>());
+    return func(DynamicDims{ rows, cols });
+}
+
+// the hot loops of a game board over its row-major, halo-padded storage. the halo makes
+// every neighbour a plain offset from the square, so none of the loops check bounds.
+// writes go through a modify(index) callback that returns a reference to the square, so
+// that the board can record changes
+template <typename Dims>
+struct BoardKernel {
+    using Squares = std::span<const GameBoardSquare, Dims::extent>;
+
+    static constexpr std::array<int32_t, 8> dir_row = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    static constexpr std::array<int32_t, 8> dir_col = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+    static constexpr std::array<int32_t, 8> offsets(Dims dims) {
+        std::array<int32_t, 8> ret = {};
+        for (int32_t k = 0; k < 8; k++)
+            ret[k] = dir_row[k] * dims.stride() + dir_col[k];
+        return ret;
+    }
+
+    template <typename Modify>
+    static void countAdjacent(Dims dims, Squares squares, Modify&& modify) {
+        const std::array<int32_t, 8> offset = offsets(dims);
+        for (int32_t i = 1; i <= dims.rows(); i++) {
+            for (int32_t j = 1; j <= dims.cols(); j++) {
+                const int32_t index = i * dims.stride() + j;
+                int adjacent_mines = 0;
+                for (int32_t k = 0; k < 8; k++)
+                    adjacent_mines += squares[index + offset[k]].is_mine;
+
+                // count first and write once, so that only squares that changed are saved
+                if (adjacent_mines != squares[index].adjacent_mines)
+                    modify(index).adjacent_mines = adjacent_mines;
+            }
+        }
+    }
+
+    // reveals the start square, and spreads out from every revealed square that has no
+    // mines around it. marked and already revealed squares (which includes the halo) are
+    // not entered. the queue is passed in so that its storage can be reused between calls
+    template <typename Modify>
+    static void floodfill(Dims dims, Squares squares, int32_t start, std::vector<int32_t>& queue, Modify&& modify) {
+        const std::array<int32_t, 8> offset = offsets(dims);
+
+        queue.clear();
+        queue.push_back(start);
+        if (!squares[start].is_revealed)
+            modify(start).is_revealed = true;
+
+        for (size_t head = 0; head < queue.size(); head++) {
+            const int32_t curr = queue[head];
+            if (squares[curr].adjacent_mines)
+                continue;
+
+            for (int32_t k = 0; k < 8; k++) {
+                const int32_t next = curr + offset[k];
+                if (squares[next].is_mine || squares[next].is_revealed || squares[next].is_marked)
+                    continue;
+                modify(next).is_revealed = true;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    // halo squares are revealed and have no mine, so they never fail the check
+    static bool didWin(Dims, Squares squares) {
+        for (size_t i = 0; i < squares.size(); i++) {
+            if (squares[i].is_revealed == squares[i].is_mine)
+                return false;
+        }
+
+        return true;
+    }
+};
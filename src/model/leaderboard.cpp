@@ -0,0 +1,382 @@
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include <QFile>
+#include <QString>
+
+#include "model/leaderboard.h"
+
+namespace {
+
+    constexpr char s_magic[4] = { 'M', 'S', 'L', 'B' };
+    constexpr uint32_t s_version = 1;
+    constexpr uint32_t s_page_size = 4096;
+    constexpr uint32_t s_initial_pages = 16;
+    // far more levels than any real tree has; a deeper walk is going around in circles
+    constexpr int32_t s_max_depth = 16;
+
+    // page 0 holds the header, every other page is a leaf or an inner page
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t page_size;
+        uint32_t page_count; // pages in use; the file may be larger
+        uint32_t root;
+        uint32_t next_order;
+        uint64_t size;
+    };
+
+    struct PageHeader {
+        uint16_t is_leaf;
+        uint16_t count;
+        uint32_t next; // the next leaf in key order, 0 for the last one and inner pages
+    };
+
+    constexpr int32_t s_leaf_capacity = (s_page_size - sizeof(PageHeader)) / sizeof(LeaderboardEntry);
+    constexpr int32_t s_inner_capacity = (s_page_size - sizeof(PageHeader)) / (2 * sizeof(uint32_t) + sizeof(LeaderboardKey));
+
+    struct LeafPage {
+        PageHeader header;
+        LeaderboardEntry entries[s_leaf_capacity];
+    };
+
+    // child i holds the entries from keys[i] up to keys[i + 1], counts[i] of them
+    struct InnerPage {
+        PageHeader header;
+        uint32_t children[s_inner_capacity];
+        uint32_t counts[s_inner_capacity];
+        LeaderboardKey keys[s_inner_capacity];
+    };
+
+    static_assert(sizeof(FileHeader) <= s_page_size);
+    static_assert(sizeof(LeafPage) <= s_page_size);
+    static_assert(sizeof(InnerPage) <= s_page_size);
+
+    bool keyLess(const LeaderboardEntry& entry, const LeaderboardKey& key) {
+        return entry.key < key;
+    }
+
+    // the child whose range contains key
+    int32_t childFor(const InnerPage& inner, const LeaderboardKey& key) {
+        const LeaderboardKey* end = inner.keys + inner.header.count;
+        const LeaderboardKey* it = std::upper_bound(inner.keys + 1, end, key);
+        return std::max<int32_t>(0, it - inner.keys - 1);
+    }
+
+    // inserts value at position into an array that holds count elements
+    template <typename T>
+    void insertAt(T* array, int32_t count, int32_t position, const T& value) {
+        std::memmove(array + position + 1, array + position, (count - position) * sizeof(T));
+        array[position] = value;
+    }
+
+}
+
+uint64_t leaderboardConfig(const GameSettings& settings) {
+    // assisted games are ranked apart, their times are not comparable
+    const uint64_t policy = uint64_t(settings.is_safe_first_move) | uint64_t(settings.is_clear_first_move) << 1
+        | uint64_t(settings.is_auto_chord) << 2 | uint64_t(settings.is_auto_flag) << 3;
+    return uint64_t(settings.row_size) << 40 | uint64_t(settings.col_size) << 24 | uint64_t(settings.num_mines) << 8 | policy;
+}
+
+Leaderboard::~Leaderboard() {
+    close();
+}
+
+bool Leaderboard::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite))
+        return false;
+
+    const bool is_new = m_file.size() == 0;
+    if (is_new && !m_file.resize(s_initial_pages * s_page_size)) {
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_file.size());
+    if (!m_data) {
+        m_file.close();
+        return false;
+    }
+
+    FileHeader* header = reinterpret_cast<FileHeader*>(m_data);
+    if (is_new) {
+        std::memcpy(header->magic, s_magic, sizeof(s_magic));
+        header->version = s_version;
+        header->page_size = s_page_size;
+        header->page_count = 2;
+        header->root = 1;
+        header->next_order = 0;
+        header->size = 0;
+        reinterpret_cast<LeafPage*>(page(1))->header = { 1, 0, 0 };
+        return true;
+    }
+
+    const bool is_valid = m_file.size() >= qint64(sizeof(FileHeader))
+        && std::memcmp(header->magic, s_magic, sizeof(s_magic)) == 0
+        && header->version == s_version && header->page_size == s_page_size
+        && header->page_count >= 2 && qint64(header->page_count) * s_page_size <= m_file.size()
+        && header->root > 0 && header->root < header->page_count;
+    if (!is_valid)
+        close();
+    return is_valid;
+}
+
+void Leaderboard::close() {
+    if (m_data)
+        m_file.unmap(m_data);
+    m_data = nullptr;
+    m_file.close();
+}
+
+bool Leaderboard::isOpen() const {
+    return m_data != nullptr;
+}
+
+uchar* Leaderboard::page(uint32_t index) const {
+    return m_data + uint64_t(index) * s_page_size;
+}
+
+const void* Leaderboard::checkedPage(uint32_t index) const {
+    if (index == 0 || index >= reinterpret_cast<const FileHeader*>(m_data)->page_count)
+        return nullptr;
+
+    const PageHeader* header = reinterpret_cast<const PageHeader*>(page(index));
+    if (header->is_leaf > 1)
+        return nullptr;
+    if (header->is_leaf ? header->count > s_leaf_capacity : (header->count == 0 || header->count > s_inner_capacity))
+        return nullptr;
+    return header;
+}
+
+bool Leaderboard::reserve(uint32_t pages) {
+    // the file grows by doubling, which moves the mapping, so every page pointer that was
+    // taken before this call is invalid afterwards
+    const qint64 needed = (qint64(reinterpret_cast<const FileHeader*>(m_data)->page_count) + pages) * s_page_size;
+    if (needed <= m_file.size())
+        return true;
+
+    qint64 size = m_file.size();
+    while (size < needed)
+        size *= 2;
+    m_file.unmap(m_data);
+    m_data = m_file.resize(size) ? m_file.map(0, size) : nullptr;
+    return m_data != nullptr;
+}
+
+uint32_t Leaderboard::allocate() {
+    FileHeader* header = reinterpret_cast<FileHeader*>(m_data);
+    const uint32_t index = header->page_count;
+    assert(qint64(index + 1) * s_page_size <= m_file.size()); // see reserve()
+    header->page_count++;
+    std::memset(page(index), 0, s_page_size);
+    return index;
+}
+
+uint64_t Leaderboard::total(uint32_t index) const {
+    const PageHeader* header = reinterpret_cast<const PageHeader*>(page(index));
+    if (header->is_leaf)
+        return header->count;
+
+    const InnerPage* inner = reinterpret_cast<const InnerPage*>(header);
+    uint64_t sum = 0;
+    for (int32_t i = 0; i < inner->header.count; i++)
+        sum += inner->counts[i];
+    return sum;
+}
+
+int64_t Leaderboard::insert(LeaderboardEntry entry) {
+    if (!m_data)
+        return 0;
+
+    // the path of the entry is checked before anything is written, and every split along
+    // it gets its page up front (plus one for a new root), so an insert either happens
+    // completely or not at all
+    int32_t depth = 0;
+    const LeaderboardKey path_key = { entry.key.config, entry.key.time_ms, reinterpret_cast<FileHeader*>(m_data)->next_order };
+    for (uint32_t index = reinterpret_cast<FileHeader*>(m_data)->root;; depth++) {
+        const PageHeader* page_header = static_cast<const PageHeader*>(checkedPage(index));
+        if (!page_header || depth > s_max_depth) {
+            close();
+            return 0;
+        }
+        if (page_header->is_leaf)
+            break;
+        const InnerPage* inner = reinterpret_cast<const InnerPage*>(page_header);
+        index = inner->children[childFor(*inner, path_key)];
+    }
+    if (!reserve(depth + 2)) {
+        close();
+        return 0;
+    }
+
+    FileHeader* header = reinterpret_cast<FileHeader*>(m_data);
+    entry.key.order = header->next_order++;
+    const uint32_t old_root = header->root;
+    const Split split = insertInto(old_root, entry);
+    if (split.happened) {
+        // the tree grows at the top: a new root over the old one and its sibling
+        const uint32_t root = allocate();
+        InnerPage* inner = reinterpret_cast<InnerPage*>(page(root));
+        const PageHeader* left = reinterpret_cast<const PageHeader*>(page(old_root));
+        inner->header = { 0, 2, 0 };
+        inner->children[0] = old_root;
+        inner->children[1] = split.page;
+        inner->counts[0] = total(old_root);
+        inner->counts[1] = total(split.page);
+        inner->keys[0] = left->is_leaf
+            ? reinterpret_cast<const LeafPage*>(left)->entries[0].key
+            : reinterpret_cast<const InnerPage*>(left)->keys[0];
+        inner->keys[1] = split.key;
+        reinterpret_cast<FileHeader*>(m_data)->root = root;
+    }
+
+    reinterpret_cast<FileHeader*>(m_data)->size++;
+    return countLess(entry.key) - countLess({ entry.key.config, 0, 0 }) + 1;
+}
+
+Leaderboard::Split Leaderboard::insertInto(uint32_t index, const LeaderboardEntry& entry) {
+    if (reinterpret_cast<const PageHeader*>(page(index))->is_leaf) {
+        LeafPage* leaf = reinterpret_cast<LeafPage*>(page(index));
+        const int32_t count = leaf->header.count;
+        const int32_t position = std::lower_bound(leaf->entries, leaf->entries + count, entry.key, keyLess) - leaf->entries;
+        if (count < s_leaf_capacity) {
+            insertAt(leaf->entries, count, position, entry);
+            leaf->header.count++;
+            return {};
+        }
+
+        // a full leaf is split in half, and the new entry goes where it belongs
+        const uint32_t right_index = allocate();
+        leaf = reinterpret_cast<LeafPage*>(page(index));
+        LeafPage* right = reinterpret_cast<LeafPage*>(page(right_index));
+        std::vector<LeaderboardEntry> all(leaf->entries, leaf->entries + count);
+        all.insert(all.begin() + position, entry);
+        const int32_t left_count = all.size() / 2;
+        std::copy(all.begin(), all.begin() + left_count, leaf->entries);
+        std::copy(all.begin() + left_count, all.end(), right->entries);
+        right->header = { 1, uint16_t(all.size() - left_count), leaf->header.next };
+        leaf->header.count = left_count;
+        leaf->header.next = right_index;
+        return { true, right_index, right->entries[0].key };
+    }
+
+    InnerPage* inner = reinterpret_cast<InnerPage*>(page(index));
+    const int32_t child = childFor(*inner, entry.key);
+    const uint32_t child_index = inner->children[child];
+    inner->counts[child]++;
+    inner->keys[child] = std::min(inner->keys[child], entry.key);
+    const Split below = insertInto(child_index, entry);
+    if (!below.happened)
+        return {};
+
+    // the child split, so its new sibling goes right after it
+    inner = reinterpret_cast<InnerPage*>(page(index));
+    const int32_t count = inner->header.count;
+    const uint32_t left_total = total(child_index);
+    const uint32_t right_total = total(below.page);
+    inner->counts[child] = left_total;
+    if (count < s_inner_capacity) {
+        insertAt(inner->children, count, child + 1, below.page);
+        insertAt(inner->counts, count, child + 1, right_total);
+        insertAt(inner->keys, count, child + 1, below.key);
+        inner->header.count++;
+        return {};
+    }
+
+    const uint32_t right_index = allocate();
+    inner = reinterpret_cast<InnerPage*>(page(index));
+    InnerPage* right = reinterpret_cast<InnerPage*>(page(right_index));
+    std::vector<uint32_t> children(inner->children, inner->children + count);
+    std::vector<uint32_t> counts(inner->counts, inner->counts + count);
+    std::vector<LeaderboardKey> keys(inner->keys, inner->keys + count);
+    children.insert(children.begin() + child + 1, below.page);
+    counts.insert(counts.begin() + child + 1, right_total);
+    keys.insert(keys.begin() + child + 1, below.key);
+
+    const int32_t left_count = children.size() / 2;
+    const int32_t right_count = children.size() - left_count;
+    std::copy(children.begin(), children.begin() + left_count, inner->children);
+    std::copy(counts.begin(), counts.begin() + left_count, inner->counts);
+    std::copy(keys.begin(), keys.begin() + left_count, inner->keys);
+    std::copy(children.begin() + left_count, children.end(), right->children);
+    std::copy(counts.begin() + left_count, counts.end(), right->counts);
+    std::copy(keys.begin() + left_count, keys.end(), right->keys);
+    inner->header.count = left_count;
+    right->header = { 0, uint16_t(right_count), 0 };
+    return { true, right_index, right->keys[0] };
+}
+
+uint64_t Leaderboard::countLess(const LeaderboardKey& key) const {
+    uint32_t index = reinterpret_cast<const FileHeader*>(m_data)->root;
+    uint64_t less = 0;
+    for (int32_t depth = 0; depth <= s_max_depth; depth++) {
+        const PageHeader* header = static_cast<const PageHeader*>(checkedPage(index));
+        if (!header)
+            break;
+        if (header->is_leaf) {
+            const LeafPage* leaf = reinterpret_cast<const LeafPage*>(header);
+            return less + (std::lower_bound(leaf->entries, leaf->entries + leaf->header.count, key, keyLess) - leaf->entries);
+        }
+
+        const InnerPage* inner = reinterpret_cast<const InnerPage*>(header);
+        const int32_t child = childFor(*inner, key);
+        for (int32_t i = 0; i < child; i++)
+            less += inner->counts[i];
+        index = inner->children[child];
+    }
+
+    return less; // a damaged file; the count is as far as it could be followed
+}
+
+int64_t Leaderboard::count(uint64_t config) const {
+    if (!m_data)
+        return 0;
+    return countLess({ config + 1, 0, 0 }) - countLess({ config, 0, 0 });
+}
+
+std::vector<LeaderboardEntry> Leaderboard::entries(uint64_t config, int64_t first, int64_t count) const {
+    std::vector<LeaderboardEntry> result;
+    if (!m_data || first < 0 || count <= 0 || first >= this->count(config))
+        return result;
+
+    // walks down to the entry with the wanted overall position using the counts, then
+    // follows the leaf chain
+    uint64_t position = countLess({ config, 0, 0 }) + first;
+    uint32_t index = reinterpret_cast<const FileHeader*>(m_data)->root;
+    for (int32_t depth = 0;; depth++) {
+        const PageHeader* header = static_cast<const PageHeader*>(checkedPage(index));
+        if (!header || depth > s_max_depth)
+            return result;
+        if (header->is_leaf)
+            break;
+        const InnerPage* inner = reinterpret_cast<const InnerPage*>(header);
+        int32_t child = 0;
+        while (child + 1 < inner->header.count && position >= inner->counts[child])
+            position -= inner->counts[child++];
+        index = inner->children[child];
+    }
+
+    // a damaged chain of leaves could go in circles, but no chain is longer than the file
+    const uint32_t page_count = reinterpret_cast<const FileHeader*>(m_data)->page_count;
+    result.reserve(std::min<int64_t>(count, this->count(config) - first));
+    for (uint32_t steps = 0; index && steps < page_count && int64_t(result.size()) < count; steps++) {
+        const LeafPage* leaf = static_cast<const LeafPage*>(checkedPage(index));
+        if (!leaf || !leaf->header.is_leaf)
+            return result;
+        for (int32_t i = position; i < leaf->header.count && int64_t(result.size()) < count; i++) {
+            if (leaf->entries[i].key.config != config)
+                return result;
+            result.push_back(leaf->entries[i]);
+        }
+        position = 0;
+        index = leaf->header.next;
+    }
+
+    return result;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <bit>
+#include <vector>
+#include <cstdint>
+
+#include <QFile>
+#include <QString>
+
+#include "model/data.h"
+
+// the best times of every board configuration in one file. the file is a b+ tree of
+// fixed size pages that is mapped and used in place, so opening it reads nothing and a
+// lookup touches one page per level. every inner page also stores the number of entries
+// below each child, which makes ranks (how many entries come before a key) as cheap as a
+// lookup. the format is little endian, like the corpus files
+static_assert(std::endian::native == std::endian::little, "leaderboard files are used in place");
+
+// a board configuration: size, mine count, first move policy and assists
+uint64_t leaderboardConfig(const GameSettings& settings);
+
+// entries are ordered by configuration, then time, then insertion, so equal times rank
+// in the order they were set
+struct LeaderboardKey {
+    uint64_t config;
+    uint32_t time_ms;
+    uint32_t order;
+    auto operator<=>(const LeaderboardKey& other) const = default;
+};
+
+struct LeaderboardEntry {
+    LeaderboardKey key;
+    char code[24]; // board code that replays the board, empty if it was imported or has no code
+    int64_t date; // seconds since the epoch
+    uint16_t clicks;
+    uint16_t bbbv;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(LeaderboardKey) == 16);
+static_assert(sizeof(LeaderboardEntry) == 56);
+
+class Leaderboard {
+public:
+    ~Leaderboard();
+
+    // creates the file if it does not exist
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const;
+
+    // the order of the key is filled in. returns the rank of the entry within its
+    // configuration, starting at 1, or 0 if the board is not open. if the file cannot
+    // grow, or the pages the entry would go through are damaged, nothing is written, the
+    // board is closed and 0 is returned
+    int64_t insert(LeaderboardEntry entry);
+    int64_t count(uint64_t config) const;
+    // up to count entries of a configuration, starting at the given rank (from 0)
+    std::vector<LeaderboardEntry> entries(uint64_t config, int64_t first, int64_t count) const;
+
+private:
+    struct Split {
+        bool happened = false;
+        uint32_t page = 0; // the new right sibling
+        LeaderboardKey key = {}; // its smallest key
+    };
+
+    Split insertInto(uint32_t page, const LeaderboardEntry& entry);
+    // makes room for pages more pages, so that allocate() never has to grow the file in
+    // the middle of an insert
+    bool reserve(uint32_t pages);
+    uint32_t allocate();
+    // the header of a page that is in use and whose count fits its kind, or nullptr if
+    // the file is damaged there. every page index read from the file goes through this
+    const void* checkedPage(uint32_t index) const;
+    uint64_t total(uint32_t page) const;
+    // number of entries that are ordered before key
+    uint64_t countLess(const LeaderboardKey& key) const;
+    uchar* page(uint32_t index) const;
+
+private:
+    QFile m_file;
+    uchar* m_data = nullptr;
+};
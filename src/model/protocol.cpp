@@ -0,0 +1,171 @@
+#include <cstdint>
+
+#include <QString>
+#include <QByteArray>
+
+#include "model/protocol.h"
+
+namespace {
+
+    constexpr int32_t s_length_size = 2;
+    constexpr int32_t s_move_size = 3;
+    constexpr int32_t s_progress_size = 15;
+    constexpr int32_t s_max_code_size = 32; // a board code is 19 characters today
+    constexpr int32_t s_spectator_header = 11; // see model/delta.h
+
+    constexpr uint8_t s_flag_won = 1 << 0;
+    constexpr uint8_t s_flag_lost = 1 << 1;
+    constexpr uint8_t s_flag_rejected = 1 << 2;
+
+    void putLittle(QByteArray& out, uint32_t value, int32_t bytes) {
+        for (int32_t i = 0; i < bytes; i++)
+            out.append(char((value >> (8 * i)) & 0xFF));
+    }
+
+    uint32_t getLittle(const QByteArray& in, int32_t offset, int32_t bytes) {
+        uint32_t value = 0;
+        for (int32_t i = 0; i < bytes; i++)
+            value |= uint32_t(uint8_t(in[offset + i])) << (8 * i);
+        return value;
+    }
+
+    QByteArray frame(RaceMessage type, int32_t payload_size) {
+        QByteArray out;
+        out.reserve(s_length_size + 1 + payload_size);
+        putLittle(out, 1 + payload_size, s_length_size);
+        putLittle(out, uint8_t(type), 1);
+        return out;
+    }
+
+    bool isValidSize(RaceMessage type, int32_t payload_size) {
+        switch (type) {
+        case RaceMessage::Welcome:
+            return payload_size > 4 && payload_size <= 4 + s_max_code_size;
+        case RaceMessage::Move:
+            return payload_size == s_move_size;
+        case RaceMessage::Progress:
+        case RaceMessage::Standing:
+            return payload_size == s_progress_size;
+        case RaceMessage::Keyframe:
+            return payload_size >= s_spectator_header + 2;
+        case RaceMessage::Delta:
+            return payload_size >= s_spectator_header;
+        }
+        return false;
+    }
+
+}
+
+QByteArray beginRaceFrame(RaceMessage type) {
+    return frame(type, 0);
+}
+
+bool endRaceFrame(QByteArray& frame) {
+    const qsizetype length = frame.size() - s_length_size;
+    if (length > UINT16_MAX)
+        return false;
+    frame[0] = char(length & 0xFF);
+    frame[1] = char(length >> 8);
+    return true;
+}
+
+QByteArray encodeRaceWelcome(const RaceWelcome& welcome) {
+    const QByteArray code = welcome.code.toLatin1();
+    QByteArray out = frame(RaceMessage::Welcome, 4 + code.size());
+    putLittle(out, welcome.player, 4);
+    out.append(code);
+    return out;
+}
+
+QByteArray encodeRaceMove(const RaceMoveMessage& move) {
+    QByteArray out = frame(RaceMessage::Move, s_move_size);
+    putLittle(out, uint8_t(move.move), 1);
+    putLittle(out, move.coord.row, 1);
+    putLittle(out, move.coord.col, 1);
+    return out;
+}
+
+QByteArray encodeRaceProgress(RaceMessage type, const RaceProgress& progress) {
+    uint8_t flags = 0;
+    flags |= progress.won ? s_flag_won : 0;
+    flags |= progress.lost ? s_flag_lost : 0;
+    flags |= progress.rejected ? s_flag_rejected : 0;
+
+    QByteArray out = frame(type, s_progress_size);
+    putLittle(out, progress.player, 4);
+    putLittle(out, flags, 1);
+    putLittle(out, progress.mines, 2);
+    putLittle(out, progress.clicks, 2);
+    putLittle(out, progress.rank, 2);
+    putLittle(out, progress.time_ms, 4);
+    return out;
+}
+
+bool decodeRaceWelcome(const QByteArray& payload, RaceWelcome& welcome) {
+    if (!isValidSize(RaceMessage::Welcome, payload.size()))
+        return false;
+    welcome.player = getLittle(payload, 0, 4);
+    welcome.code = QString::fromLatin1(payload.mid(4));
+    return true;
+}
+
+bool decodeRaceMove(const QByteArray& payload, RaceMoveMessage& move) {
+    if (payload.size() != s_move_size)
+        return false;
+    const uint8_t type = getLittle(payload, 0, 1);
+    if (type > uint8_t(RaceMove::Mark))
+        return false;
+    move.move = RaceMove(type);
+    move.coord = { int32_t(getLittle(payload, 1, 1)), int32_t(getLittle(payload, 2, 1)) };
+    return true;
+}
+
+bool decodeRaceProgress(const QByteArray& payload, RaceProgress& progress) {
+    if (payload.size() != s_progress_size)
+        return false;
+    const uint8_t flags = getLittle(payload, 4, 1);
+    progress.player = getLittle(payload, 0, 4);
+    progress.won = flags & s_flag_won;
+    progress.lost = flags & s_flag_lost;
+    progress.rejected = flags & s_flag_rejected;
+    // the mine counter goes negative when more flags than mines are placed
+    progress.mines = int16_t(getLittle(payload, 5, 2));
+    progress.clicks = getLittle(payload, 7, 2);
+    progress.rank = getLittle(payload, 9, 2);
+    progress.time_ms = getLittle(payload, 11, 4);
+    return true;
+}
+
+void RaceFrameReader::append(const QByteArray& bytes) {
+    // the consumed prefix is only dropped when new bytes arrive, so that taking frames
+    // out never moves memory
+    if (m_offset > 0) {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+    m_buffer.append(bytes);
+}
+
+bool RaceFrameReader::next(RaceMessage& type, QByteArray& payload) {
+    if (m_failed || m_buffer.size() - m_offset < s_length_size + 1)
+        return false;
+
+    const int32_t length = getLittle(m_buffer, m_offset, s_length_size);
+    const uint8_t raw_type = getLittle(m_buffer, m_offset + s_length_size, 1);
+    if (raw_type < uint8_t(RaceMessage::Welcome) || raw_type > uint8_t(RaceMessage::Delta)
+        || !isValidSize(RaceMessage(raw_type), length - 1)) {
+        m_failed = true;
+        return false;
+    }
+
+    if (m_buffer.size() - m_offset < s_length_size + length)
+        return false;
+    type = RaceMessage(raw_type);
+    payload = m_buffer.mid(m_offset + s_length_size + 1, length - 1);
+    m_offset += s_length_size + length;
+    return true;
+}
+
+bool RaceFrameReader::failed() const {
+    return m_failed;
+}
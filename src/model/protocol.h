@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+#include <QString>
+#include <QByteArray>
+
+#include "model/data.h"
+#include "model/board.h"
+
+// the wire format of races (see RaceServer and RaceClient). every message is one frame:
+// a little endian u16 with the number of bytes that follow, a u8 message type, and a
+// payload of a fixed size for that type (only the welcome and the spectator frames have
+// a variable size)
+//
+//   welcome   server -> client  u32 player, board code (latin-1, see model/code.h)
+//   move      client -> server  u8 move, u8 row, u8 col
+//   progress  server -> client  u32 player, u8 flags, u16 mines, u16 clicks, u16 rank, u32 time ms
+//   standing  server -> all     same as progress, sent when any player finishes
+//   keyframe  server -> spectator  a whole board, see model/delta.h
+//   delta     server -> spectator  the squares one action changed, see model/delta.h
+enum class RaceMessage : uint8_t {
+    Welcome = 1,
+    Move = 2,
+    Progress = 3,
+    Standing = 4,
+    Keyframe = 5,
+    Delta = 6
+};
+
+enum class RaceMove : uint8_t {
+    Reveal = 0, // also chords when the square is a revealed number
+    Mark = 1
+};
+
+struct RaceWelcome {
+    uint32_t player = 0;
+    QString code = QString();
+};
+
+struct RaceMoveMessage {
+    RaceMove move = RaceMove::Reveal;
+    GameBoardCoord coord = { 0, 0 };
+};
+
+struct RaceProgress {
+    uint32_t player = 0;
+    bool won = false;
+    bool lost = false;
+    bool rejected = false; // the move was not valid for the board or the game had ended
+    int32_t mines = 0;
+    int32_t clicks = 0;
+    int32_t rank = 0; // finishing place among the winners, 0 until won
+    uint32_t time_ms = 0;
+};
+
+QByteArray encodeRaceWelcome(const RaceWelcome& welcome);
+QByteArray encodeRaceMove(const RaceMoveMessage& move);
+// type is either progress or standing
+QByteArray encodeRaceProgress(RaceMessage type, const RaceProgress& progress);
+
+// for payloads whose size is only known once written: begin a frame, append the payload
+// and end it, which fills in the length. ending fails if the payload is too large
+QByteArray beginRaceFrame(RaceMessage type);
+bool endRaceFrame(QByteArray& frame);
+
+// each returns false if the payload does not have the size or values of its type
+bool decodeRaceWelcome(const QByteArray& payload, RaceWelcome& welcome);
+bool decodeRaceMove(const QByteArray& payload, RaceMoveMessage& move);
+bool decodeRaceProgress(const QByteArray& payload, RaceProgress& progress);
+
+// splits a byte stream back into frames. bytes are appended as they arrive and complete
+// frames are taken out one at a time; a frame with an unknown type or a size that no
+// message has puts the reader into a failed state, after which the peer should be dropped
+class RaceFrameReader {
+public:
+    void append(const QByteArray& bytes);
+    // returns false if there is no complete frame (yet)
+    bool next(RaceMessage& type, QByteArray& payload);
+    bool failed() const;
+
+private:
+    QByteArray m_buffer = {};
+    qsizetype m_offset = 0; // bytes of the buffer that were already taken out
+    bool m_failed = false;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// small random number generators for mine generation. unlike std::mt19937 these have a
+// few words of state, seed in constant time, and produce the same numbers with every
+// standard library (as does boundedRandom, unlike std::uniform_int_distribution)
+
+// the splitmix64 output function. a good 64 bit hash on its own, used to expand seeds
+inline uint64_t mixBits(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// counter based generation: the counter-th number of the stream identified by key. there is
+// no state to carry, so any position of any stream can be computed directly, and many
+// streams can be advanced in lockstep
+inline uint64_t counterRandom(uint64_t key, uint64_t counter) {
+    return mixBits(key + counter * 0x9E3779B97F4A7C15ull);
+}
+
+// xoshiro256**, usable with the standard distributions. streams derived from the same seed
+// start at unrelated states, and jump() skips 2^128 numbers ahead for guaranteed
+// non-overlapping sequences
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed, uint64_t stream = 0) {
+        const uint64_t key = mixBits(seed) ^ mixBits(stream + 0x9E3779B97F4A7C15ull);
+        for (uint64_t i = 0; i < 4; i++)
+            m_state[i] = counterRandom(key, i);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        const uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+
+    void jump() {
+        constexpr uint64_t table[4] = {
+            0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+            0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull
+        };
+
+        uint64_t next[4] = {};
+        for (uint64_t word : table) {
+            for (int32_t bit = 0; bit < 64; bit++) {
+                if (word & (1ull << bit)) {
+                    for (int32_t i = 0; i < 4; i++)
+                        next[i] ^= m_state[i];
+                }
+                (*this)();
+            }
+        }
+
+        for (int32_t i = 0; i < 4; i++)
+            m_state[i] = next[i];
+    }
+
+private:
+    static uint64_t rotl(uint64_t value, int32_t shift) {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+private:
+    uint64_t m_state[4];
+};
+
+// maps 32 random bits into [0, range) with a multiplication instead of a division. very
+// slightly biased on its own; see boundedRandom
+inline uint32_t scaleRandom(uint32_t random, uint32_t range) {
+    return (uint64_t(random) * range) >> 32;
+}
+
+// an unbiased integer in [0, range), with lemire's method: multiply, and only draw again
+// in the rare case that the low half of the product lands in the biased zone
+template <typename Engine>
+uint32_t boundedRandom(Engine& engine, uint32_t range) {
+    uint64_t product = uint64_t(uint32_t(engine() >> 32)) * range;
+    if (uint32_t(product) < range) {
+        const uint32_t threshold = -range % range;
+        while (uint32_t(product) < threshold)
+            product = uint64_t(uint32_t(engine() >> 32)) * range;
+    }
+
+    return product >> 32;
+}
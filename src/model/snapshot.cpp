@@ -0,0 +1,155 @@
+#include <bit>
+#include <vector>
+#include <cstdint>
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include "model/snapshot.h"
+
+namespace {
+
+    // layout of a version 2 snapshot: "MSGS", version, rows (2), cols (2), mines (4),
+    // seed (4), settings flags, game flags, mines left (4), timer (8), clicks (4), first
+    // row (4), first col (4), assist flags, assist budget (4), then the mine bitmap and
+    // the visible bitmap. version 1 ends the header before the assist flags, and its
+    // games are resumed with the assists off
+    constexpr char s_magic[4] = { 'M', 'S', 'G', 'S' };
+    constexpr uint8_t s_version = 2;
+    constexpr int32_t s_header_size = 48;
+    constexpr int32_t s_header_size_v1 = 43;
+
+    constexpr uint8_t s_flag_question = 1 << 0;
+    constexpr uint8_t s_flag_safe = 1 << 1;
+    constexpr uint8_t s_flag_clear = 1 << 2;
+    constexpr uint8_t s_flag_set_seed = 1 << 3;
+    constexpr int32_t s_flag_generator_shift = 4;
+
+    constexpr uint8_t s_flag_won = 1 << 0;
+    constexpr uint8_t s_flag_lost = 1 << 1;
+    constexpr uint8_t s_flag_first_reveal = 1 << 2;
+    constexpr uint8_t s_flag_imported = 1 << 3;
+
+    constexpr uint8_t s_flag_auto_chord = 1 << 0;
+    constexpr uint8_t s_flag_auto_flag = 1 << 1;
+
+    void putLittle(QByteArray& out, uint64_t value, int32_t bytes) {
+        for (int32_t i = 0; i < bytes; i++)
+            out.append(char((value >> (8 * i)) & 0xFF));
+    }
+
+    uint64_t getLittle(const QByteArray& in, int32_t offset, int32_t bytes) {
+        uint64_t value = 0;
+        for (int32_t i = 0; i < bytes; i++)
+            value |= uint64_t(uint8_t(in[offset + i])) << (8 * i);
+        return value;
+    }
+
+}
+
+QByteArray encodeGameSnapshot(const GameSnapshot& snapshot) {
+    const GameSettings& settings = snapshot.settings;
+    const GameState& state = snapshot.state;
+    uint8_t settings_flags = uint8_t(settings.generator) << s_flag_generator_shift;
+    settings_flags |= settings.is_question_enabled ? s_flag_question : 0;
+    settings_flags |= settings.is_safe_first_move ? s_flag_safe : 0;
+    settings_flags |= settings.is_clear_first_move ? s_flag_clear : 0;
+    settings_flags |= settings.is_set_seed ? s_flag_set_seed : 0;
+    uint8_t game_flags = 0;
+    game_flags |= state.won ? s_flag_won : 0;
+    game_flags |= state.lost ? s_flag_lost : 0;
+    game_flags |= state.is_first_reveal ? s_flag_first_reveal : 0;
+    game_flags |= snapshot.is_imported ? s_flag_imported : 0;
+    uint8_t assist_flags = 0;
+    assist_flags |= settings.is_auto_chord ? s_flag_auto_chord : 0;
+    assist_flags |= settings.is_auto_flag ? s_flag_auto_flag : 0;
+
+    QByteArray data;
+    data.reserve(s_header_size + snapshot.mines.size() + snapshot.visible.size());
+    data.append(s_magic, sizeof(s_magic));
+    putLittle(data, s_version, 1);
+    putLittle(data, settings.row_size, 2);
+    putLittle(data, settings.col_size, 2);
+    putLittle(data, settings.num_mines, 4);
+    putLittle(data, settings.seed, 4);
+    putLittle(data, settings_flags, 1);
+    putLittle(data, game_flags, 1);
+    putLittle(data, uint32_t(state.mines), 4);
+    putLittle(data, uint64_t(state.timer), 8);
+    putLittle(data, uint32_t(state.clicks), 4);
+    putLittle(data, uint32_t(state.first_row), 4);
+    putLittle(data, uint32_t(state.first_col), 4);
+    putLittle(data, assist_flags, 1);
+    putLittle(data, uint32_t(settings.assist_budget), 4);
+    data.append(reinterpret_cast<const char*>(snapshot.mines.data()), snapshot.mines.size());
+    data.append(reinterpret_cast<const char*>(snapshot.visible.data()), snapshot.visible.size());
+    return data;
+}
+
+bool decodeGameSnapshot(const QByteArray& data, GameSnapshot& snapshot) {
+    if (data.size() < s_header_size_v1 || !data.startsWith(QByteArrayView(s_magic, sizeof(s_magic))))
+        return false;
+    const uint8_t version = getLittle(data, 4, 1);
+    if (version != 1 && version != s_version)
+        return false;
+    const int32_t header_size = (version == 1) ? s_header_size_v1 : s_header_size;
+
+    const int32_t rows = getLittle(data, 5, 2);
+    const int32_t cols = getLittle(data, 7, 2);
+    const int32_t mines_size = (int64_t(rows) * cols + 7) / 8;
+    const int32_t visible_size = (int64_t(rows) * cols + 1) / 2;
+    if (!rows || !cols || data.size() != int64_t(header_size) + mines_size + visible_size)
+        return false;
+
+    const uint8_t settings_flags = getLittle(data, 17, 1);
+    const uint8_t generator = settings_flags >> s_flag_generator_shift;
+    if (generator > uint8_t(GameGenerator::Xoshiro))
+        return false;
+
+    GameSnapshot result;
+    result.settings.row_size = rows;
+    result.settings.col_size = cols;
+    result.settings.num_mines = getLittle(data, 9, 4);
+    result.settings.seed = getLittle(data, 13, 4);
+    result.settings.is_question_enabled = settings_flags & s_flag_question;
+    result.settings.is_safe_first_move = settings_flags & s_flag_safe;
+    result.settings.is_clear_first_move = settings_flags & s_flag_clear;
+    result.settings.is_set_seed = settings_flags & s_flag_set_seed;
+    result.settings.generator = GameGenerator(generator);
+
+    const uint8_t game_flags = getLittle(data, 18, 1);
+    result.state.won = game_flags & s_flag_won;
+    result.state.lost = game_flags & s_flag_lost;
+    result.state.is_first_reveal = game_flags & s_flag_first_reveal;
+    result.is_imported = game_flags & s_flag_imported;
+    result.state.mines = int32_t(getLittle(data, 19, 4));
+    result.state.timer = int64_t(getLittle(data, 23, 8));
+    result.state.clicks = int32_t(getLittle(data, 31, 4));
+    result.state.first_row = int32_t(getLittle(data, 35, 4));
+    result.state.first_col = int32_t(getLittle(data, 39, 4));
+    if (version != 1) {
+        const uint8_t assist_flags = getLittle(data, 43, 1);
+        result.settings.is_auto_chord = assist_flags & s_flag_auto_chord;
+        result.settings.is_auto_flag = assist_flags & s_flag_auto_flag;
+        result.settings.assist_budget = int32_t(getLittle(data, 44, 4));
+        if (result.settings.assist_budget <= 0)
+            return false;
+    }
+
+    const char* bits = data.constData() + header_size;
+    result.mines.assign(bits, bits + mines_size);
+    result.visible.assign(bits + mines_size, bits + mines_size + visible_size);
+
+    // like a mine bitmap file, the count has to agree with the bits
+    const int32_t tail_bits = (int64_t(rows) * cols) % 8;
+    if (tail_bits && (result.mines.back() >> tail_bits))
+        return false;
+    int32_t counted = 0;
+    for (uint8_t byte : result.mines)
+        counted += std::popcount(byte);
+    if (counted != result.settings.num_mines || result.state.timer < 0)
+        return false;
+
+    snapshot = std::move(result);
+    return true;
+}
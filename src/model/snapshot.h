@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <QByteArray>
+
+#include "model/data.h"
+
+// a game in progress, with everything needed to continue it: the settings (and so the
+// seed), the state including the time played so far, the mines and what the player can
+// see. the history of moves is not kept, so a resumed game starts with nothing to undo
+struct GameSnapshot {
+    GameSettings settings = GameSettings();
+    GameState state = GameState();
+    bool is_imported = false; // see App, the mines did not come from the seed
+    std::vector<uint8_t> mines = {}; // see GameBoard::mineBitmap
+    std::vector<uint8_t> visible = {}; // see GameBoard::visibleBitmap
+};
+
+// a fixed header followed by the two bitmaps, so a large board is mostly copied
+QByteArray encodeGameSnapshot(const GameSnapshot& snapshot);
+// returns false if the data is truncated, from an unknown version, or inconsistent
+bool decodeGameSnapshot(const QByteArray& data, GameSnapshot& snapshot);
@@ -0,0 +1,227 @@
+#include <cmath>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "model/solver.h"
+#include "model/random.h"
+#include "model/feasibility.h"
+
+namespace {
+
+    // a revealed number and the hidden squares around it that are not known to be mines.
+    // need is how many of those squares are mines
+    struct Constraint {
+        int32_t need = 0;
+        int32_t count = 0;
+        std::array<int32_t, 8> squares = {};
+    };
+
+    class Solver {
+    public:
+        Solver(GameBoard& board, uint64_t seed) :
+            m_board(board), m_rows(board.rowSize()), m_cols(board.colSize()), m_engine(seed) {
+            m_is_mine.assign(m_rows * m_cols, 0);
+            m_constraint_at.assign(m_rows * m_cols, -1);
+        }
+
+        bool play(const GameBoardCoord& first_click, int32_t num_mines) {
+            GameState state;
+            state.mines = num_mines;
+            m_board.reveal(first_click, state);
+            while (!state.won && !state.lost) {
+                if (!deduce())
+                    m_safe.push_back(guess(num_mines));
+                if (m_safe.back() < 0)
+                    return false; // only mines are left, which a won game would have noticed
+                for (int32_t square : m_safe) {
+                    if (state.won || state.lost)
+                        break;
+                    if (!revealed(square))
+                        m_board.reveal({ square / m_cols, square % m_cols }, state);
+                }
+                m_safe.clear();
+            }
+            return state.won;
+        }
+
+    private:
+        bool revealed(int32_t square) const {
+            return m_board.getSquare({ square / m_cols, square % m_cols }).is_revealed;
+        }
+
+        // calls visit with every square around center that is on the board
+        template <typename Visit>
+        void forNeighbours(int32_t center, Visit visit) const {
+            const int32_t row = center / m_cols, col = center % m_cols;
+            for (int32_t i = std::max(row - 1, 0); i <= std::min(row + 1, m_rows - 1); i++) {
+                for (int32_t j = std::max(col - 1, 0); j <= std::min(col + 1, m_cols - 1); j++) {
+                    if (i != row || j != col)
+                        visit(i * m_cols + j);
+                }
+            }
+        }
+
+        void buildConstraints() {
+            m_constraints.clear();
+            std::fill(m_constraint_at.begin(), m_constraint_at.end(), -1);
+            for (int32_t center = 0; center < m_rows * m_cols; center++) {
+                const GameBoardSquare& square = m_board.getSquare({ center / m_cols, center % m_cols });
+                if (!square.is_revealed || !square.adjacent_mines)
+                    continue;
+                Constraint constraint;
+                constraint.need = square.adjacent_mines;
+                forNeighbours(center, [&](int32_t adj) {
+                    if (m_is_mine[adj])
+                        constraint.need--;
+                    else if (!revealed(adj))
+                        constraint.squares[constraint.count++] = adj;
+                });
+                if (!constraint.count)
+                    continue;
+                m_constraint_at[center] = m_constraints.size();
+                m_constraints.push_back(constraint);
+            }
+        }
+
+        // the squares of diff are safe if they hold no mines, and mines if they all do.
+        // returns true if a mine was found, which changes every constraint around it
+        bool settle(const int32_t* diff, int32_t count, int32_t need) {
+            bool found_mine = false;
+            for (int32_t i = 0; i < count && (need == 0 || need == count); i++) {
+                if (need == 0) {
+                    m_safe.push_back(diff[i]);
+                } else if (!m_is_mine[diff[i]]) {
+                    m_is_mine[diff[i]] = 1;
+                    found_mine = true;
+                }
+            }
+            return found_mine;
+        }
+
+        // fills m_safe with every square that can be proven safe. returns false if there is none
+        bool deduce() {
+            while (true) {
+                buildConstraints();
+                bool found_mine = false;
+                for (const Constraint& constraint : m_constraints)
+                    found_mine |= settle(constraint.squares.data(), constraint.count, constraint.need);
+                if (found_mine)
+                    continue;
+                if (!m_safe.empty())
+                    return true;
+
+                // a number whose hidden squares are all around another number too: the
+                // squares only the second one sees hold the difference of their mines.
+                // the two numbers are at most two squares apart
+                for (int32_t center = 0; center < m_rows * m_cols && !found_mine; center++) {
+                    if (m_constraint_at[center] < 0)
+                        continue;
+                    const Constraint& inner = m_constraints[m_constraint_at[center]];
+                    const int32_t row = center / m_cols, col = center % m_cols;
+                    for (int32_t i = std::max(row - 2, 0); i <= std::min(row + 2, m_rows - 1); i++) {
+                        for (int32_t j = std::max(col - 2, 0); j <= std::min(col + 2, m_cols - 1); j++) {
+                            const int32_t other = m_constraint_at[i * m_cols + j];
+                            if (other < 0 || other == m_constraint_at[center])
+                                continue;
+                            const Constraint& outer = m_constraints[other];
+                            if (outer.count <= inner.count)
+                                continue;
+
+                            std::array<int32_t, 8> diff = {};
+                            int32_t diff_count = 0, shared = 0;
+                            for (int32_t k = 0; k < outer.count; k++) {
+                                const int32_t* end = inner.squares.data() + inner.count;
+                                if (std::find(inner.squares.data(), end, outer.squares[k]) != end)
+                                    shared++;
+                                else
+                                    diff[diff_count++] = outer.squares[k];
+                            }
+                            if (shared == inner.count)
+                                found_mine |= settle(diff.data(), diff_count, outer.need - inner.need);
+                        }
+                    }
+                }
+                if (found_mine)
+                    continue;
+                return !m_safe.empty();
+            }
+        }
+
+        // the hidden square least likely to be a mine. next to numbers that is the worst
+        // share of mines among the numbers around it, elsewhere it is the share of the
+        // mines that are left among the squares that are left
+        int32_t guess(int32_t num_mines) {
+            int32_t unknown = 0, known_mines = 0;
+            for (int32_t square = 0; square < m_rows * m_cols; square++) {
+                known_mines += m_is_mine[square];
+                unknown += !m_is_mine[square] && !revealed(square);
+            }
+
+            m_risk.assign(m_rows * m_cols, -1);
+            for (const Constraint& constraint : m_constraints) {
+                for (int32_t k = 0; k < constraint.count; k++) {
+                    double& value = m_risk[constraint.squares[k]];
+                    value = std::max(value, double(constraint.need) / constraint.count);
+                }
+            }
+
+            const double density = unknown ? double(num_mines - known_mines) / unknown : 1;
+            int32_t best = -1, ties = 0;
+            double best_risk = 2;
+            for (int32_t square = 0; square < m_rows * m_cols; square++) {
+                if (m_is_mine[square] || revealed(square))
+                    continue;
+                const double value = (m_risk[square] < 0) ? density : m_risk[square];
+                if (value < best_risk) {
+                    best = square;
+                    best_risk = value;
+                    ties = 1;
+                } else if (value == best_risk && boundedRandom(m_engine, ++ties) == 0) {
+                    best = square; // every tied square is equally likely to be picked
+                }
+            }
+            return best;
+        }
+
+    private:
+        GameBoard& m_board;
+        int32_t m_rows, m_cols;
+        Xoshiro256 m_engine;
+        std::vector<uint8_t> m_is_mine;
+        std::vector<int32_t> m_constraint_at; // index into m_constraints of every number, or -1
+        std::vector<Constraint> m_constraints;
+        std::vector<int32_t> m_safe;
+        std::vector<double> m_risk;
+    };
+
+}
+
+WinRateEstimate estimateWinRate(int64_t games, int64_t wins) {
+    WinRateEstimate estimate;
+    estimate.games = games;
+    estimate.wins = wins;
+    if (!games)
+        return estimate;
+
+    const double n = games;
+    const double p = wins / n;
+    const double z = 1.96;
+    const double scale = 1 + z * z / n;
+    const double center = (p + z * z / (2 * n)) / scale;
+    const double half = z * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / scale;
+    estimate.rate = p;
+    estimate.lower = std::max(center - half, 0.0);
+    estimate.upper = std::min(center + half, 1.0);
+    return estimate;
+}
+
+bool solveGame(GameBoard& board, const GameSettings& settings, const GameBoardCoord& first_click, uint64_t seed) {
+    // the first reveal would generate nothing, and every guess after it too
+    if (!isFeasible(settings, first_click))
+        return false;
+    board.reset(settings);
+    Solver solver(board, seed);
+    return solver.play(first_click, settings.num_mines);
+}
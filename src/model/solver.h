@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include "model/data.h"
+#include "model/board.h"
+
+// plays one game to the end, the way a careful player would. it reveals every square that
+// the numbers prove safe, first from single numbers and then from pairs of nearby numbers
+// whose hidden squares contain one another. when nothing is proven it guesses the square
+// with the lowest estimated chance of a mine. it never marks anything, and it keeps the
+// mines it has found to itself.
+//
+// the board is reset with settings, whose seed picks the layout, and the first reveal is
+// at first_click. ties between guesses are broken with seed. returns true if the game was
+// won, and false if it was lost or the mines do not fit around first_click
+bool solveGame(GameBoard& board, const GameSettings& settings, const GameBoardCoord& first_click, uint64_t seed);
+
+// how often the solver wins a configuration, from a sample of games
+struct WinRateEstimate {
+    int64_t games = 0;
+    int64_t wins = 0;
+    double rate = 0;
+    // the 95% wilson score interval of the rate, which stays inside [0, 1] and behaves
+    // with few games or rates near 0 and 1
+    double lower = 0, upper = 1;
+    bool is_done = false; // no more games will be added
+};
+
+WinRateEstimate estimateWinRate(int64_t games, int64_t wins);
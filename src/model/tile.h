@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "model/board.h"
+
+// what the player sees of a square: the distinction GameView::renderButton draws, and
+// nothing more. every tile fits in four bits, so spectator frames (see model/delta.h)
+// pack two squares per byte
+enum class BoardTile : uint8_t {
+    // 0 to 8 are revealed squares with that many adjacent mines
+    Hidden = 9,
+    Flag = 10,
+    Question = 11,
+    Mine = 12,
+    Exploded = 13,
+    WrongFlag = 14
+};
+
+inline uint8_t boardTile(const GameBoardSquare& square) {
+    if (!square.is_revealed) {
+        if (square.is_marked)
+            return uint8_t(BoardTile::Flag);
+        return uint8_t(square.is_question ? BoardTile::Question : BoardTile::Hidden);
+    }
+
+    if (square.is_mine)
+        return uint8_t(square.is_end_reason ? BoardTile::Exploded : BoardTile::Mine);
+    if (square.is_marked)
+        return uint8_t(BoardTile::WrongFlag);
+    return square.adjacent_mines;
+}
@@ -133,4 +133,8 @@ void ButtonView::mouseReleaseEvent(QMouseEvent* event) {
 
 void ButtonView::setClickable(bool clickable) {
     m_clickable = clickable;
-}
\ No newline at end of file
+}
+
+void ButtonView::setCoord(const GameBoardCoord& coord) {
+    m_coord = coord;
+}
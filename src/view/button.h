@@ -12,6 +12,8 @@ class ButtonView : public QPushButton {
 public:
     explicit ButtonView(const GameBoardCoord& coord, QWidget* parent = nullptr);
     void setClickable(bool clickable);
+    // buttons are reused between boards, see GameView::initBoard
+    void setCoord(const GameBoardCoord& coord);
 
 private slots:
     void mousePressEvent(QMouseEvent* event) override;
@@ -0,0 +1,267 @@
+#include <cmath>
+#include <algorithm>
+
+#include <QFont>
+#include <QColor>
+#include <QPainter>
+#include <QPolygon>
+#include <QNativeGestureEvent>
+
+#include "view/canvas.h"
+
+namespace {
+
+    const QColor s_background(205, 205, 205);
+    const QColor s_exploded(255, 0, 0);
+    const QColor s_light(255, 255, 255);
+    const QColor s_dark(128, 128, 128);
+
+    // the colours of the mine_1 to mine_8 button styles
+    const QColor s_numbers[9] = {
+        QColor(0, 0, 0), QColor(32, 32, 245), QColor(0, 128, 0), QColor(255, 0, 0), QColor(0, 0, 128),
+        QColor(128, 0, 0), QColor(0, 128, 128), QColor(0, 0, 0), QColor(128, 128, 128)
+    };
+
+    // a raised (or, when pressed, sunken) square like the regular button style
+    void drawBevel(QPainter& painter, const QRect& rect, bool pressed) {
+        const int32_t width = std::max(1, rect.width() / 8);
+        const QPoint top_left = rect.topLeft();
+        const QPoint top_right = rect.topRight() + QPoint(1, 0);
+        const QPoint bottom_left = rect.bottomLeft() + QPoint(0, 1);
+        const QPoint bottom_right = rect.bottomRight() + QPoint(1, 1);
+        const QPoint inset(width, width);
+
+        painter.fillRect(rect, s_background);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(pressed ? s_dark : s_light);
+        painter.drawPolygon(QPolygon({ top_left, top_right, top_right + QPoint(-width, width), top_left + inset, bottom_left + QPoint(width, -width), bottom_left }));
+        painter.setBrush(pressed ? s_light : s_dark);
+        painter.drawPolygon(QPolygon({ bottom_right, bottom_left, bottom_left + QPoint(width, -width), bottom_right - inset, top_right + QPoint(-width, width), top_right }));
+    }
+
+    // an opened square like the disabled and numbered button styles
+    void drawFlat(QPainter& painter, const QRect& rect, const QColor& background) {
+        painter.fillRect(rect, background);
+        painter.setPen(s_dark);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(rect.adjusted(0, 0, -1, -1));
+    }
+
+}
+
+BoardCanvas::BoardCanvas(const QString& font, QWidget* parent) : QWidget(parent) {
+    m_font = font;
+    m_flag = QPixmap(":/assets/board/flag.png");
+    m_mine = QPixmap(":/assets/board/mine.png");
+    m_cross = QPixmap(":/assets/board/cross.png");
+    setAttribute(Qt::WA_OpaquePaintEvent); // every pixel is covered by a tile
+}
+
+void BoardCanvas::resizeBoard(int32_t rows, int32_t cols) {
+    m_rows = rows;
+    m_cols = cols;
+    m_tiles.assign(rows * cols, uint8_t(BoardTile::Hidden));
+    m_left = m_right = { -1, -1 };
+    setFixedSize(m_cols * m_tile_size, m_rows * m_tile_size);
+    update();
+}
+
+void BoardCanvas::setTile(const GameBoardCoord& coord, uint8_t tile) {
+    uint8_t& current = m_tiles[coord.row * m_cols + coord.col];
+    if (current == tile)
+        return;
+    current = tile;
+    update(tileRect(coord));
+}
+
+void BoardCanvas::setPlayable(bool playable) {
+    if (m_playable == playable)
+        return;
+    m_playable = playable;
+    if (m_left.row >= 0)
+        update(tileRect(m_left));
+}
+
+void BoardCanvas::setTileSize(int32_t size) {
+    size = std::clamp(size, s_min_tile_size, s_max_tile_size);
+    if (size == m_tile_size)
+        return;
+    m_tile_size = size;
+    setFixedSize(m_cols * m_tile_size, m_rows * m_tile_size);
+    update();
+}
+
+int32_t BoardCanvas::tileSize() const {
+    return m_tile_size;
+}
+
+const QPixmap& BoardCanvas::atlas(qreal ratio) {
+    const std::pair<int32_t, qreal> key = { m_tile_size, ratio };
+    const auto found = m_atlases.find(key);
+    if (found != m_atlases.end())
+        return found->second;
+
+    if (m_atlases.size() >= size_t(s_max_atlases))
+        m_atlases.clear();
+    // one row of tiles at the full resolution of the screen, drawn in logical pixels
+    QPixmap pixmap(int(std::ceil(s_atlas_tiles * m_tile_size * ratio)), int(std::ceil(m_tile_size * ratio)));
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(s_background);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    for (int32_t tile = 0; tile < s_atlas_tiles; tile++)
+        drawTile(painter, QRect(tile * m_tile_size, 0, m_tile_size, m_tile_size), tile);
+    painter.end();
+    return m_atlases.emplace(key, std::move(pixmap)).first->second;
+}
+
+void BoardCanvas::drawTile(QPainter& painter, const QRect& rect, int32_t tile) const {
+    // the icons keep the margin of the buttons, whose icons are a tenth smaller
+    const int32_t margin = std::max(1, rect.width() / 10);
+    const QRect icon_rect = rect.adjusted(margin, margin, -margin, -margin);
+    QFont font(m_font);
+    font.setPixelSize(std::max(1, rect.height() * 6 / 10));
+    painter.setFont(font);
+
+    if (tile == s_pressed_tile) {
+        drawBevel(painter, rect, true);
+    } else if (tile <= 8) {
+        drawFlat(painter, rect, s_background);
+        if (tile > 0) {
+            // the font pack has the digits at the 74th character, see GameView::renderButton
+            painter.setPen(s_numbers[tile]);
+            painter.drawText(rect, Qt::AlignCenter, QString(QChar(char16_t(74 + tile))));
+        }
+    } else {
+        switch (BoardTile(tile)) {
+        case BoardTile::Hidden:
+            drawBevel(painter, rect, false);
+            break;
+        case BoardTile::Flag:
+            drawBevel(painter, rect, false);
+            painter.drawPixmap(icon_rect, m_flag);
+            break;
+        case BoardTile::Question:
+            drawBevel(painter, rect, false);
+            painter.setPen(Qt::black);
+            painter.drawText(rect, Qt::AlignCenter, "?");
+            break;
+        case BoardTile::Mine:
+            drawFlat(painter, rect, s_background);
+            painter.drawPixmap(icon_rect, m_mine);
+            break;
+        case BoardTile::Exploded:
+            drawFlat(painter, rect, s_exploded);
+            painter.drawPixmap(icon_rect, m_mine);
+            break;
+        case BoardTile::WrongFlag:
+            drawFlat(painter, rect, s_background);
+            painter.drawPixmap(icon_rect, m_cross);
+            break;
+        }
+    }
+}
+
+void BoardCanvas::paintEvent(QPaintEvent* event) {
+    // the ratio is looked up on every paint, so a move to another screen picks (or renders
+    // once) the atlas for it without anything else changing
+    const qreal ratio = devicePixelRatioF();
+    const QPixmap& tiles = atlas(ratio);
+    const qreal source_size = m_tile_size * ratio;
+
+    const QRect dirty = event->rect();
+    const int32_t first_row = std::max(0, dirty.top() / m_tile_size);
+    const int32_t last_row = std::min(m_rows - 1, dirty.bottom() / m_tile_size);
+    const int32_t first_col = std::max(0, dirty.left() / m_tile_size);
+    const int32_t last_col = std::min(m_cols - 1, dirty.right() / m_tile_size);
+
+    QPainter painter(this);
+    for (int32_t i = first_row; i <= last_row; i++) {
+        for (int32_t j = first_col; j <= last_col; j++) {
+            int32_t tile = m_tiles[i * m_cols + j];
+            if (m_playable && tile == uint8_t(BoardTile::Hidden) && m_left.row == i && m_left.col == j)
+                tile = s_pressed_tile;
+            const QRectF source(tile * source_size, 0, source_size, source_size);
+            painter.drawPixmap(QRectF(j * m_tile_size, i * m_tile_size, m_tile_size, m_tile_size), tiles, source);
+        }
+    }
+}
+
+void BoardCanvas::mousePressEvent(QMouseEvent* event) {
+    const GameBoardCoord coord = coordAt(event->position().toPoint());
+    if (coord.row < 0)
+        return;
+
+    if (event->button() == Qt::LeftButton) {
+        m_left = coord;
+        update(tileRect(coord));
+        emit lmbPressed(coord);
+    } else if (event->button() == Qt::RightButton) {
+        m_right = coord;
+    }
+}
+
+void BoardCanvas::mouseReleaseEvent(QMouseEvent* event) {
+    // like a button, a release belongs to the square the press was on
+    const GameBoardCoord coord = coordAt(event->position().toPoint());
+    if (event->button() == Qt::LeftButton && m_left.row >= 0) {
+        const GameBoardCoord pressed = m_left;
+        m_left = { -1, -1 };
+        update(tileRect(pressed));
+        if (coord.row == pressed.row && coord.col == pressed.col) {
+            emit lmbReleasedInside(pressed);
+        } else {
+            emit lmbReleasedOutside(pressed);
+        }
+    } else if (event->button() == Qt::RightButton && m_right.row >= 0) {
+        const GameBoardCoord pressed = m_right;
+        m_right = { -1, -1 };
+        emit rmbReleased(pressed);
+    }
+}
+
+void BoardCanvas::wheelEvent(QWheelEvent* event) {
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QWidget::wheelEvent(event);
+        return;
+    }
+
+    // one notch is 120 units and zooms by two pixels. touchpads and free spinning wheels
+    // send a fraction of a notch per event, which adds up until it is a whole one
+    m_wheel += event->angleDelta().y();
+    const int32_t notches = m_wheel / 120;
+    m_wheel -= notches * 120;
+    if (notches)
+        setTileSize(m_tile_size + 2 * notches);
+    event->accept();
+}
+
+bool BoardCanvas::event(QEvent* event) {
+    if (event->type() == QEvent::NativeGesture) {
+        const QNativeGestureEvent* gesture = static_cast<QNativeGestureEvent*>(event);
+        if (gesture->gestureType() == Qt::ZoomNativeGesture) {
+            m_pinch += gesture->value();
+            const int32_t size = std::lround(m_tile_size * (1 + m_pinch));
+            if (size != m_tile_size) {
+                setTileSize(size);
+                m_pinch = 0;
+            }
+            return true;
+        }
+    }
+
+    return QWidget::event(event);
+}
+
+QRect BoardCanvas::tileRect(const GameBoardCoord& coord) const {
+    return QRect(coord.col * m_tile_size, coord.row * m_tile_size, m_tile_size, m_tile_size);
+}
+
+GameBoardCoord BoardCanvas::coordAt(const QPoint& position) const {
+    const int32_t row = position.y() / m_tile_size;
+    const int32_t col = position.x() / m_tile_size;
+    if (position.x() < 0 || position.y() < 0 || row >= m_rows || col >= m_cols)
+        return { -1, -1 };
+    return { row, col };
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include <QWidget>
+#include <QPixmap>
+#include <QString>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QWheelEvent>
+
+#include "model/board.h"
+#include "model/tile.h"
+
+// the whole board as one widget that draws its squares from a tile atlas, instead of one
+// button per square. the tile size is a single number that can change at any time (ctrl
+// and the wheel, or a pinch, zoom), and the atlas is rendered once for each tile size and
+// device pixel ratio it is drawn at, so zooming or moving to another screen only repaints.
+// the signals are the ones of ButtonView
+class BoardCanvas : public QWidget {
+    Q_OBJECT
+public:
+    explicit BoardCanvas(const QString& font, QWidget* parent = nullptr);
+
+    // every square starts hidden
+    void resizeBoard(int32_t rows, int32_t cols);
+    // tile is a BoardTile value. only the square is repainted, and all repaints of one
+    // frame are merged by qt
+    void setTile(const GameBoardCoord& coord, uint8_t tile);
+    // a finished game has no pressable squares
+    void setPlayable(bool playable);
+    void setTileSize(int32_t size);
+    int32_t tileSize() const;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    bool event(QEvent* event) override;
+
+signals:
+    void lmbPressed(const GameBoardCoord& coord) const;
+    void lmbReleasedInside(const GameBoardCoord& coord) const;
+    void lmbReleasedOutside(const GameBoardCoord& coord) const;
+    void rmbReleased(const GameBoardCoord& coord) const;
+
+private:
+    const QPixmap& atlas(qreal ratio);
+    void drawTile(QPainter& painter, const QRect& rect, int32_t tile) const;
+    QRect tileRect(const GameBoardCoord& coord) const;
+    GameBoardCoord coordAt(const QPoint& position) const;
+
+private:
+    static constexpr int32_t s_min_tile_size = 12;
+    static constexpr int32_t s_max_tile_size = 96;
+    static constexpr int32_t s_max_atlases = 16;
+    // the atlas also has a pressed hidden square after the board tiles
+    static constexpr int32_t s_pressed_tile = 15;
+    static constexpr int32_t s_atlas_tiles = 16;
+
+    int32_t m_rows = 0, m_cols = 0;
+    int32_t m_tile_size = 24;
+    qreal m_pinch = 0; // pinch zoom that did not add up to a whole pixel yet
+    int32_t m_wheel = 0; // wheel rotation that did not add up to a notch yet
+    std::vector<uint8_t> m_tiles = {};
+    bool m_playable = true;
+    GameBoardCoord m_left = { -1, -1 }, m_right = { -1, -1 }; // where each button went down
+
+    // by tile size and device pixel ratio. every zoom step leaves one behind, so the cache
+    // is emptied once it holds s_max_atlases of them
+    std::map<std::pair<int32_t, qreal>, QPixmap> m_atlases = {};
+    QString m_font;
+    QPixmap m_flag, m_mine, m_cross;
+};
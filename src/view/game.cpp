@@ -1,7 +1,10 @@
 #include <QString>
 #include <QPointF>
 #include <QMouseEvent>
+#include <QScreen>
+#include <QTimer>
 #include <QFontDatabase>
+#include <QFontMetrics>
 
 #include <QAction>
 #include <QIcon>
@@ -9,8 +12,10 @@
 #include <QPixmap>
 #include <QMenu>
 #include <QWidget>
+#include <QLayoutItem>
 
 #include <cmath>
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
@@ -26,6 +31,12 @@ GameView::GameView(const GameBoard& init_board, QWidget* parent) : QMainWindow(p
     setupMenu();
     setupFontAndIcons();
     
+    m_ui->board_widget_layout->setContentsMargins(11 + m_min_size / 300, 0, 11 + m_min_size / 300, 12 + m_min_size / 150);
+
+    m_frame_timer = new QTimer(this);
+    m_frame_timer->setSingleShot(true);
+    m_frame_timer->callOnTimeout(this, &GameView::renderFrame);
+
     connect(m_ui->window_close, &QPushButton::clicked, this, &GameView::onClose);
     connect(m_ui->window_min, &QPushButton::clicked, this, &GameView::onMinimize);
     connect(m_ui->ctrl_button_restart, &QPushButton::clicked, this, &GameView::onRestart);
@@ -61,18 +72,31 @@ void GameView::setupFontAndIcons() {
 void GameView::setupMenu() {
     QMenu* game_menu_inner = new QMenu(this);
     game_menu_inner->addAction(m_ui->action_new_game);
+    game_menu_inner->addAction(m_ui->action_undo);
+    game_menu_inner->addAction(m_ui->action_redo);
     game_menu_inner->addSeparator();
     game_menu_inner->addAction(m_ui->action_beginner);
     game_menu_inner->addAction(m_ui->action_intermediate);
     game_menu_inner->addAction(m_ui->action_expert);
     game_menu_inner->addSeparator();
+    game_menu_inner->addAction(m_ui->action_copy_code);
+    game_menu_inner->addAction(m_ui->action_export_mines);
+    game_menu_inner->addAction(m_ui->action_import_mines);
+    game_menu_inner->addSeparator();
+    game_menu_inner->addAction(m_ui->action_leaderboard);
     game_menu_inner->addAction(m_ui->action_options);
     m_ui->menu_game->setMenu(game_menu_inner);
     
     connect(m_ui->action_new_game, &QAction::triggered, this, &GameView::onRestart);
+    connect(m_ui->action_undo, &QAction::triggered, this, &GameView::onActionUndo);
+    connect(m_ui->action_redo, &QAction::triggered, this, &GameView::onActionRedo);
     connect(m_ui->action_beginner, &QAction::triggered, this, &GameView::onActionBeginner);
     connect(m_ui->action_intermediate, &QAction::triggered, this, &GameView::onActionIntermediate);
     connect(m_ui->action_expert, &QAction::triggered, this, &GameView::onActionAdvanced);
+    connect(m_ui->action_copy_code, &QAction::triggered, this, &GameView::onActionCopyCode);
+    connect(m_ui->action_export_mines, &QAction::triggered, this, &GameView::onActionExportMines);
+    connect(m_ui->action_import_mines, &QAction::triggered, this, &GameView::onActionImportMines);
+    connect(m_ui->action_leaderboard, &QAction::triggered, this, &GameView::onActionLeaderboard);
     connect(m_ui->action_options, &QAction::triggered, this, &GameView::onActionOptions);
 
     QMenu* help_menu_inner = new QMenu(this);
@@ -86,60 +110,131 @@ void GameView::setupMenu() {
     connect(m_ui->action_github, &QAction::triggered, this, &GameView::onActionGithub);
     connect(m_ui->action_about, &QAction::triggered, this, &GameView::onActionAbout);
 
+    // the menus are only shown on demand, so the shortcuts have to be registered with the
+    // window itself to be active while the menu is closed
+    addAction(m_ui->action_undo);
+    addAction(m_ui->action_redo);
+
     m_ui->menu_bar->layout()->setContentsMargins(6, m_min_size / 450, 12, 0);
 }
 
 void GameView::clearBoard() {
-    delete m_ui->board_widget_layout;
-    m_ui->board_widget_layout = new QGridLayout(m_ui->board_widget);
-    m_ui->board_widget_layout->setSpacing(0);
-    m_ui->board_widget_layout->setObjectName("board_widget_layout");
-    m_ui->board_widget_layout->setContentsMargins(11 + m_min_size / 300, 0, 11 + m_min_size / 300, 12 + m_min_size / 150);
+    // only the layout items are deleted. the buttons stay in the pool for the next board
+    while (QLayoutItem* item = m_ui->board_widget_layout->takeAt(0))
+        delete item;
+    for (int32_t i = 0; i < m_ui->board_widget_layout->rowCount(); i++)
+        m_ui->board_widget_layout->setRowMinimumHeight(i, 0);
+}
 
-    for (int32_t i = 0; i < m_buttons.size(); i++) {
-        for (int32_t j = 0; j < m_buttons[0].size(); j++) {
-            delete m_buttons[i][j];
-        }
-    }
+ButtonView* GameView::button(int32_t row, int32_t col) const {
+    return m_buttons[row * m_button_cols + col];
 }
 
 void GameView::updateBoard(const GameBoard& board, const GameState& state, bool first_render) {
     updateControlIcon(state);
-    assert(board.rowSize() == m_buttons.size() && board.colSize() == m_buttons[0].size());
+    assert(board.rowSize() == m_button_rows && board.colSize() == m_button_cols);
+    if (m_canvas)
+        m_canvas->setPlayable(!state.won && !state.lost);
     for (int32_t i = 0; i < board.rowSize(); i++) {
         for (int32_t j = 0; j < board.colSize(); j++) {
             if (first_render || m_prev_state != state || board.getSquare({ i, j }) != m_prev_board.getSquare({ i, j })) {
                 // due to the performance overhead of updating/repainting widgets with
                 // stylesheets, we should only update mine squares that have been updated.
-                renderButton(board.getSquare({ i, j }), state, m_buttons[i][j]);
+                renderSquare({ i, j }, board.getSquare({ i, j }), state);
             }
         }
     }
     
     m_prev_state = state;
-    m_prev_board = board;
+    m_prev_board.assign(board);
+}
+
+void GameView::scheduleUpdate(const GameBoard& board, const GameState& state, const std::vector<GameBoardChange>& changes, bool all_dirty) {
+    m_frame_board = &board;
+    m_frame_state = state;
+    m_all_dirty |= all_dirty;
+    for (const GameBoardChange& change : changes)
+        m_dirty.push_back(change.coord);
+
+    if (!m_frame_timer->isActive()) {
+        const qreal refresh_rate = screen() ? screen()->refreshRate() : 60;
+        m_frame_timer->start(std::max(1, int(1000 / refresh_rate)));
+    }
+}
+
+void GameView::renderFrame() {
+    if (!m_frame_board)
+        return;
+
+    // how a square is drawn only depends on the game state through won/lost, so any other
+    // state change (e.g. the chord preview face) does not need a pass over the board
+    const GameState& state = m_frame_state;
+    if (m_all_dirty || state.won != m_prev_state.won || state.lost != m_prev_state.lost) {
+        updateBoard(*m_frame_board, state);
+    } else {
+        updateControlIcon(state);
+        for (const GameBoardCoord& coord : m_dirty) {
+            const GameBoardSquare& square = m_frame_board->getSquare(coord);
+            if (square != m_prev_board.getSquare(coord)) {
+                renderSquare(coord, square, state);
+                m_prev_board.setSquare(coord, square);
+            }
+        }
+        m_prev_state = state;
+    }
+
+    m_dirty.clear();
+    m_all_dirty = false;
 }
 
 void GameView::initBoard(const GameBoard& board, const GameState& state, bool first_render) {
+    // anything still queued refers to the old board; the full render below replaces it
+    m_frame_timer->stop();
+    m_dirty.clear();
+    m_all_dirty = false;
     clearBoard();
-    m_buttons.assign(board.rowSize(), std::vector<ButtonView*>(board.colSize(), nullptr));
+    m_button_rows = board.rowSize();
+    m_button_cols = board.colSize();
+    if (m_canvas) {
+        // one widget whatever the size, so there is nothing to create or lay out per square
+        m_canvas->resizeBoard(m_button_rows, m_button_cols);
+        m_ui->board_widget_layout->addWidget(m_canvas, 0, 0);
+        updateBoard(board, { false, false }, true);
+        layout()->setSizeConstraint(QLayout::SetFixedSize);
+        return;
+    }
+
+    const int32_t count = m_button_rows * m_button_cols;
+
+    // buttons are never deleted, so switching between sizes only creates the buttons that
+    // the largest board so far did not need, and hides the ones that are left over
+    while (m_buttons.size() < count) {
+        ButtonView* button = new ButtonView({ 0, 0 }, m_ui->board_widget);
+        button->setFont(QFont(m_board_font, m_min_size / 85));
+        connect(button, &ButtonView::lmbReleasedInside, this, &GameView::onReveal);
+        connect(button, &ButtonView::lmbReleasedInside, this, &GameView::onLmbReleasedInside);
+        connect(button, &ButtonView::lmbReleasedOutside, this, &GameView::onLmbReleasedOutside);
+        connect(button, &ButtonView::lmbPressed, this, &GameView::onLmbPressed);
+        connect(button, &ButtonView::rmbReleased, this, &GameView::onMark);
+        m_buttons.push_back(button);
+    }
+
+    for (int32_t k = count; k < m_buttons.size(); k++)
+        m_buttons[k]->hide();
+
+    const int32_t btn_size = 30 - 2 * std::log(board.rowSize());
+    const int32_t icon_size = 27 - 2 * std::log(board.rowSize());
     for (int32_t i = 0; i < board.rowSize(); i++) {
         // we have to set minimum row height because qt is weird
         m_ui->board_widget_layout->setRowMinimumHeight(i, 26 - 2 * std::log(board.rowSize()));
 
         for (int32_t j = 0; j < board.colSize(); j++) {
-            m_buttons[i][j] = new ButtonView({ i, j }, m_ui->board_widget);
-            const int32_t btn_size = 30 - 2 * std::log(board.rowSize());
-            const int32_t icon_size = 27 - 2 * std::log(board.rowSize());
-            m_buttons[i][j]->setFixedSize(btn_size, btn_size);
-            m_buttons[i][j]->setIconSize(QSize(icon_size, icon_size));
-            m_buttons[i][j]->setFont(QFont(m_board_font, m_min_size / 85));
-            connect(m_buttons[i][j], &ButtonView::lmbReleasedInside, this, &GameView::onReveal);
-            connect(m_buttons[i][j], &ButtonView::lmbReleasedInside, this, &GameView::onLmbReleasedInside);
-            connect(m_buttons[i][j], &ButtonView::lmbReleasedOutside, this, &GameView::onLmbReleasedOutside);
-            connect(m_buttons[i][j], &ButtonView::lmbPressed, this, &GameView::onLmbPressed);
-            connect(m_buttons[i][j], &ButtonView::rmbReleased, this, &GameView::onMark);
-            m_ui->board_widget_layout->addWidget(m_buttons[i][j], i, j);
+            ButtonView* button = this->button(i, j);
+            button->setCoord({ i, j });
+            button->setFixedSize(btn_size, btn_size);
+            button->setIconSize(QSize(icon_size, icon_size));
+            m_ui->board_widget_layout->addWidget(button, i, j);
+            button->show();
         }
     }
 
@@ -148,6 +243,29 @@ void GameView::initBoard(const GameBoard& board, const GameState& state, bool fi
     LOG_INFO("window: fixed size is {}, {}", size().width(), size().height());
 }
 
+void GameView::setScalable(int32_t tile_size) {
+    if (!m_canvas) {
+        m_canvas = new BoardCanvas(m_board_font, m_ui->board_widget);
+        connect(m_canvas, &BoardCanvas::lmbReleasedInside, this, &GameView::onReveal);
+        connect(m_canvas, &BoardCanvas::lmbReleasedInside, this, &GameView::onLmbReleasedInside);
+        connect(m_canvas, &BoardCanvas::lmbReleasedOutside, this, &GameView::onLmbReleasedOutside);
+        connect(m_canvas, &BoardCanvas::lmbPressed, this, &GameView::onLmbPressed);
+        connect(m_canvas, &BoardCanvas::rmbReleased, this, &GameView::onMark);
+        for (ButtonView* button : m_buttons)
+            button->hide();
+    }
+
+    m_canvas->setTileSize(tile_size);
+}
+
+void GameView::renderSquare(const GameBoardCoord& coord, const GameBoardSquare& square, const GameState& state) const {
+    if (m_canvas) {
+        m_canvas->setTile(coord, boardTile(square));
+    } else {
+        renderButton(square, state, button(coord.row, coord.col));
+    }
+}
+
 void GameView::renderButton(const GameBoardSquare& square, const GameState& new_state, ButtonView* button) const {
     const bool square_revealed = square.is_revealed;
     const bool square_marked = square.is_marked;
@@ -199,6 +317,14 @@ void GameView::setTimePassed(int new_time) {
     m_ui->timer_display->display(new_time);
 }
 
+void GameView::setSummary(const QString& summary) {
+    // elided to the current width, so that a long summary never widens the window
+    const QString text = summary.isEmpty() ? QString("Minesweeper") : summary;
+    const QFontMetrics metrics(m_ui->window_title->font());
+    m_ui->window_title->setText(metrics.elidedText(text, Qt::ElideRight, m_ui->window_title->width()));
+    m_ui->window_title->setToolTip(summary);
+}
+
 void GameView::onRestart() const {
     emit restart();
 }
@@ -249,6 +375,14 @@ void GameView::onLmbReleasedOutside(const GameBoardCoord& coord) {
     emit revealAltUp(coord);
 }
 
+void GameView::onActionUndo() const {
+    emit actionUndo();
+}
+
+void GameView::onActionRedo() const {
+    emit actionRedo();
+}
+
 void GameView::onActionBeginner() const {
     emit actionBeginner();
 }
@@ -261,6 +395,22 @@ void GameView::onActionAdvanced() const {
     emit actionAdvanced();
 }
 
+void GameView::onActionCopyCode() const {
+    emit actionCopyCode();
+}
+
+void GameView::onActionExportMines() const {
+    emit actionExportMines();
+}
+
+void GameView::onActionImportMines() const {
+    emit actionImportMines();
+}
+
+void GameView::onActionLeaderboard() const {
+    emit actionLeaderboard();
+}
+
 void GameView::onActionAbout() const {
     emit actionAbout();
 }
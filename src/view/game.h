@@ -1,15 +1,20 @@
 #pragma once
 
+#include <vector>
+
 #include <QMainWindow>
 #include <QPointF>
 #include <QString>
 #include <QMouseEvent>
+#include <QTimer>
 
 #include "view/ui_game.h"
 #include "view/button.h"
+#include "view/canvas.h"
 #include "model/board.h"
 #include "model/data.h"
 #include "model/screen.h"
+#include "model/compressed.h"
 
 class GameView : public QMainWindow {
     Q_OBJECT
@@ -17,16 +22,26 @@ public:
     GameView() = default;
     explicit GameView(const GameBoard& init_board, QWidget* parent = nullptr);
 
-    // the updatewindow handles the case when new_board has the same size as the current
-    // window. resizewindow handles the case when new_board has a different size. the
-    // reason we want to make this distinction is because deleting the old button objects
-    // and reallocating new ones are expensive. hence, we want to provide two functions to
-    // handle both cases. 
+    // updateboard redraws the squares of a board with the same size as the window.
+    // initboard lays out a board of a new size: the buttons come from a pool that is never
+    // deleted, so it only creates the buttons that the largest board so far did not need
+    // and hides the rest. laying the buttons out again is still the slow part, which is
+    // why a board of the same size only goes through updateboard
     void updateBoard(const GameBoard& board, const GameState& state, bool first_render = false);
     void initBoard(const GameBoard& board, const GameState& state, bool first_render = false);
+    // draws the board on a single BoardCanvas with square tiles of the given size instead
+    // of with buttons, from the next initBoard on. once scalable, this only zooms
+    void setScalable(int32_t tile_size);
+    // defers rendering to the next display frame, so that any number of updates within one
+    // frame cost a single pass over the squares that changed. the board is read at the time
+    // of the frame, so it has to outlive the call. all_dirty makes the frame diff the whole
+    // board, for changes that are not listed (e.g. a reset)
+    void scheduleUpdate(const GameBoard& board, const GameState& state, const std::vector<GameBoardChange>& changes, bool all_dirty = false);
 
     void setMinesLeft(int new_mines);
     void setTimePassed(int new_time);
+    // shown in the title bar after the game ends; an empty summary restores the title
+    void setSummary(const QString& summary);
 
 protected:
     // qt custom title bar movement implementation
@@ -39,7 +54,10 @@ private:
     void setupFontAndIcons();
     void updateControlIcon(const GameState& state) const;
     void renderButton(const GameBoardSquare& square, const GameState& new_state, ButtonView* button_view) const;
+    void renderSquare(const GameBoardCoord& coord, const GameBoardSquare& square, const GameState& state) const;
     void clearBoard();
+    void renderFrame();
+    ButtonView* button(int32_t row, int32_t col) const;
 
 private slots:
     void onLmbPressed(const GameBoardCoord& coord);
@@ -52,9 +70,15 @@ private slots:
     void onMark(const GameBoardCoord& coord) const;
 
     // menu slots
+    void onActionUndo() const;
+    void onActionRedo() const;
     void onActionBeginner() const;
     void onActionIntermediate() const;
     void onActionAdvanced() const;
+    void onActionCopyCode() const;
+    void onActionExportMines() const;
+    void onActionImportMines() const;
+    void onActionLeaderboard() const;
     void onActionAbout() const;
     void onActionOptions() const;
     void onActionTutorial() const;
@@ -72,9 +96,15 @@ signals:
     void revealAltDown(const GameBoardCoord& coord) const;
     void revealAltUp(const GameBoardCoord& coord) const;
 
+    void actionUndo() const;
+    void actionRedo() const;
     void actionBeginner() const;
     void actionIntermediate() const;
     void actionAdvanced() const;
+    void actionCopyCode() const;
+    void actionExportMines() const;
+    void actionImportMines() const;
+    void actionLeaderboard() const;
     void actionAbout() const;
     void actionOptions() const;
     void actionTutorial() const;
@@ -86,9 +116,19 @@ signals:
 private:
     Ui::GameWindow* m_ui;
     GameState m_prev_state = { false, false, false };
-    GameBoard m_prev_board = GameBoard();
+    CompressedBoard m_prev_board = CompressedBoard();
     
-    std::vector<std::vector<ButtonView*>> m_buttons = {{ nullptr }};
+    // every button ever created, owned by the board widget. the first rows * cols of them
+    // are the squares of the current board in row-major order, the rest are hidden
+    std::vector<ButtonView*> m_buttons = {};
+    int32_t m_button_rows = 0, m_button_cols = 0;
+    BoardCanvas* m_canvas = nullptr; // replaces the buttons in the scalable mode
+
+    QTimer* m_frame_timer = nullptr;
+    const GameBoard* m_frame_board = nullptr;
+    GameState m_frame_state = GameState();
+    std::vector<GameBoardCoord> m_dirty = {};
+    bool m_all_dirty = false;
     QString m_board_font, m_window_font;
     QIcon m_flag, m_mine, m_wrong_mine, m_no_icon;
 
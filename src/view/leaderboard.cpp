@@ -0,0 +1,51 @@
+#include <vector>
+
+#include <QDateTime>
+#include <QHeaderView>
+#include <QString>
+#include <QTableWidgetItem>
+#include <fmt/format.h>
+
+#include "view/leaderboard.h"
+
+namespace {
+
+    constexpr int32_t s_shown_entries = 100;
+
+}
+
+LeaderboardView::LeaderboardView(const Leaderboard& leaderboard, const GameSettings& settings, QWidget* parent) : QDialog(parent) {
+    m_ui = new Ui::LeaderboardWindow();
+    m_ui->setupUi(this);
+
+    const uint64_t config = leaderboardConfig(settings);
+    const std::vector<LeaderboardEntry> entries = leaderboard.entries(config, 0, s_shown_entries);
+    const char* policy = settings.is_clear_first_move ? "clear first move" : settings.is_safe_first_move ? "safe first move" : "no first move help";
+    const char* assists = settings.is_auto_chord ? (settings.is_auto_flag ? ", auto chord and flag" : ", auto chord")
+        : (settings.is_auto_flag ? ", auto flag" : "");
+    m_ui->summary_label->setText(QString::fromStdString(fmt::format(
+        "{}x{}, {} mines, {}{}: {} won games recorded",
+        settings.row_size, settings.col_size, settings.num_mines, policy, assists, leaderboard.count(config)
+    )));
+
+    m_ui->table->setRowCount(entries.size());
+    for (int32_t i = 0; i < int32_t(entries.size()); i++) {
+        const LeaderboardEntry& entry = entries[i];
+        const QString cells[6] = {
+            QString::number(i + 1),
+            QString::fromStdString(fmt::format("{:.3f}s", entry.key.time_ms / 1000.0)),
+            QString::number(entry.bbbv),
+            QString::number(entry.clicks),
+            QDateTime::fromSecsSinceEpoch(entry.date).toString("yyyy-MM-dd hh:mm"),
+            QString::fromLatin1(entry.code, qstrnlen(entry.code, sizeof(entry.code)))
+        };
+        for (int32_t j = 0; j < 6; j++)
+            m_ui->table->setItem(i, j, new QTableWidgetItem(cells[j]));
+    }
+
+    m_ui->table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+}
+
+LeaderboardView::~LeaderboardView() {
+    delete m_ui;
+}
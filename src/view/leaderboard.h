@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QDialog>
+
+#include "model/data.h"
+#include "model/leaderboard.h"
+#include "view/ui_leaderboard.h"
+
+// the best times of one board configuration. only the rows that are shown are read from
+// the leaderboard, so it opens at the same speed however many games were recorded
+class LeaderboardView : public QDialog {
+    Q_OBJECT
+public:
+    LeaderboardView(const Leaderboard& leaderboard, const GameSettings& settings, QWidget* parent = nullptr);
+    ~LeaderboardView();
+
+private:
+    Ui::LeaderboardWindow* m_ui;
+};
@@ -1,6 +1,10 @@
+#include <cmath>
+
 #include <QKeyEvent>
 
 #include "view/options.h"
+#include "model/code.h"
+#include "model/feasibility.h"
 
 OptionsView::OptionsView(const GameSettings& settings, QWidget* parent) : QDialog(parent) {
     m_ui = new Ui::Options();
@@ -18,9 +22,13 @@ OptionsView::OptionsView(const GameSettings& settings, QWidget* parent) : QDialo
     connect(m_ui->clear_checkbox, &QCheckBox::checkStateChanged, this, &OptionsView::onClearCheckChanged);
     connect(m_ui->safe_checkbox, &QCheckBox::checkStateChanged, this, &OptionsView::onSafeCheckChanged);
     connect(m_ui->mark_checkbox, &QCheckBox::checkStateChanged, this, &OptionsView::onMarkCheckChanged);
+    connect(m_ui->auto_chord_checkbox, &QCheckBox::checkStateChanged, this, &OptionsView::onAutoChordCheckChanged);
+    connect(m_ui->auto_flag_checkbox, &QCheckBox::checkStateChanged, this, &OptionsView::onAutoFlagCheckChanged);
     // seed checkboxes
     connect(m_ui->seed_editor, &QLineEdit::editingFinished, this, &OptionsView::onSeedEditorChanged);
     connect(m_ui->seed_check, &QCheckBox::checkStateChanged, this, &OptionsView::onSeedCheckChanged);
+    connect(m_ui->generator_check, &QCheckBox::checkStateChanged, this, &OptionsView::onGeneratorCheckChanged);
+    connect(m_ui->code_editor, &QLineEdit::editingFinished, this, &OptionsView::onCodeEditorChanged);
     connect(this, &QDialog::accepted, this, &OptionsView::onDone);
 
     m_ui->row_slider->setValue(m_settings.row_size);
@@ -32,10 +40,14 @@ OptionsView::OptionsView(const GameSettings& settings, QWidget* parent) : QDialo
     m_ui->clear_checkbox->setChecked(m_settings.is_clear_first_move);
     m_ui->safe_checkbox->setChecked(m_settings.is_safe_first_move);
     m_ui->mark_checkbox->setChecked(m_settings.is_question_enabled);
+    m_ui->auto_chord_checkbox->setChecked(m_settings.is_auto_chord);
+    m_ui->auto_flag_checkbox->setChecked(m_settings.is_auto_flag);
     
     m_ui->seed_editor->setText(QString::number(m_settings.seed));
     m_ui->seed_editor->setEnabled(m_settings.is_set_seed);
     m_ui->seed_check->setChecked(m_settings.is_set_seed);
+    m_ui->generator_check->setChecked(m_settings.generator == GameGenerator::Xoshiro);
+    updateFeasibility();
 
     layout()->setSizeConstraint(QLayout::SetFixedSize);
 }
@@ -47,8 +59,8 @@ OptionsView::~OptionsView() {
 void OptionsView::enableMineCountWarning() {
     delete warn_label;
     warn_label = new QLabel(
-        "Warning: Too many mines! Automatically resizing "
-        "the number of mines down to 40% of the total board.", 
+        QString("Warning: Too many mines! Only %1 mines fit around "
+        "every first move, so the number of mines was lowered.").arg(maxMineCount()),
         nullptr);
     warn_label->setStyleSheet(".QLabel { color: rgb(220, 171, 23);}");
     warn_label->setWordWrap(true);
@@ -66,7 +78,9 @@ bool OptionsView::isValidMineCount() {
 }
 
 int32_t OptionsView::maxMineCount() {
-    return 0.4 * m_settings.row_size * m_settings.col_size;
+    // the squares the first move keeps free are the only limit, so the limit follows the
+    // first move checkboxes
+    return maxFeasibleMines(m_settings);
 }
 
 void OptionsView::checkValidMineCount() {
@@ -78,6 +92,38 @@ void OptionsView::checkValidMineCount() {
     } else {
         disableMineCountWarning();
     }
+    updateFeasibility();
+}
+
+void OptionsView::updateFeasibility() {
+    emit settingsEdited(m_settings);
+    const BoardFeasibility feasibility = checkFeasibility(m_settings);
+    if (!feasibility.is_feasible) {
+        m_ui->feasibility_label->setText("These mines do not fit on the board.");
+        return;
+    }
+
+    // small counts are shown in full, the rest as a power of ten
+    const QString layouts = (feasibility.log10_layouts < 6)
+        ? QString::number(std::round(std::pow(10.0, feasibility.log10_layouts)), 'f', 0)
+        : QString("10^%1").arg(int32_t(feasibility.log10_layouts));
+    const double per_mine = m_settings.num_mines ? feasibility.expected_draws / m_settings.num_mines : 0;
+    m_ui->feasibility_label->setText(QString("%1 possible layouts, about %2 random draws per mine to generate one.")
+        .arg(layouts).arg(per_mine, 0, 'f', 1));
+}
+
+void OptionsView::showEstimate(const WinRateEstimate& estimate) {
+    if (!estimate.games) {
+        m_ui->estimate_label->setText(estimate.is_done ? "" : "Estimating the win rate...");
+        return;
+    }
+
+    m_ui->estimate_label->setText(QString("The solver wins %1% of these games (%2% to %3%, %4 games%5).")
+        .arg(100 * estimate.rate, 0, 'f', 1)
+        .arg(100 * estimate.lower, 0, 'f', 1)
+        .arg(100 * estimate.upper, 0, 'f', 1)
+        .arg(estimate.games)
+        .arg(estimate.is_done ? "" : " so far"));
 }
 
 void OptionsView::keyPressEvent(QKeyEvent* evt) {
@@ -179,6 +225,7 @@ void OptionsView::onSafeCheckChanged(Qt::CheckState value) {
         m_settings.is_clear_first_move = false;
         m_ui->clear_checkbox->setChecked(false);
     }
+    checkValidMineCount();
 }
 
 void OptionsView::onClearCheckChanged(Qt::CheckState value) {
@@ -189,6 +236,7 @@ void OptionsView::onClearCheckChanged(Qt::CheckState value) {
     } else {
         m_settings.is_clear_first_move = false;
     }
+    checkValidMineCount();
 }
 
 void OptionsView::onMarkCheckChanged(Qt::CheckState value) {
@@ -199,6 +247,14 @@ void OptionsView::onMarkCheckChanged(Qt::CheckState value) {
     }
 }
 
+void OptionsView::onAutoChordCheckChanged(Qt::CheckState value) {
+    m_settings.is_auto_chord = (value == Qt::CheckState::Checked);
+}
+
+void OptionsView::onAutoFlagCheckChanged(Qt::CheckState value) {
+    m_settings.is_auto_flag = (value == Qt::CheckState::Checked);
+}
+
 void OptionsView::onSeedCheckChanged(Qt::CheckState value) {
     if (value == Qt::CheckState::Checked) {
         m_settings.is_set_seed = true;
@@ -210,8 +266,51 @@ void OptionsView::onSeedCheckChanged(Qt::CheckState value) {
     }
 }
 
+void OptionsView::onGeneratorCheckChanged(Qt::CheckState value) {
+    if (value == Qt::CheckState::Checked) {
+        m_settings.generator = GameGenerator::Xoshiro;
+    } else {
+        m_settings.generator = GameGenerator::Mt19937;
+    }
+}
+
+void OptionsView::onCodeEditorChanged() {
+    GameSettings decoded = m_settings;
+    const QString code = m_ui->code_editor->text();
+    if (code.isEmpty() || !decodeBoardCode(code, decoded, m_anchor)) {
+        m_ui->code_editor->clear();
+        m_ui->code_editor->setPlaceholderText(code.isEmpty() ? "Board Code (optional)" : "Invalid Board Code");
+        m_has_code = false;
+        return;
+    }
+
+    // show what the code contains. the widgets may clamp values from codes made with other
+    // limits, so the decoded settings are taken over as they are afterwards
+    m_ui->seed_editor->setText(QString::number(decoded.seed));
+    m_ui->row_slider->setValue(decoded.row_size);
+    m_ui->col_slider->setValue(decoded.col_size);
+    m_ui->mine_slider->setValue(decoded.num_mines);
+    m_ui->safe_checkbox->setChecked(decoded.is_safe_first_move);
+    m_ui->clear_checkbox->setChecked(decoded.is_clear_first_move);
+    m_ui->mark_checkbox->setChecked(decoded.is_question_enabled);
+    m_ui->seed_check->setChecked(decoded.is_set_seed);
+    m_ui->generator_check->setChecked(decoded.generator == GameGenerator::Xoshiro);
+    m_settings = decoded;
+    disableMineCountWarning();
+    updateFeasibility();
+    m_has_code = true;
+}
+
 void OptionsView::onDone() {
+    if (m_has_code) {
+        // the size may have been edited after the code was entered
+        if (m_anchor.row >= m_settings.row_size || m_anchor.col >= m_settings.col_size)
+            m_anchor = { -1, -1 };
+        emit applyBoardCode(m_settings, m_anchor);
+        return;
+    }
+
     if (!isValidMineCount())
-        m_settings.num_mines = (int32_t) 0.4 * m_settings.row_size * m_settings.col_size;
+        m_settings.num_mines = maxMineCount();
     emit applySettings(m_settings);
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <QString>
 
 #include "model/data.h"
+#include "model/board.h"
+#include "model/solver.h"
 #include "view/ui_options.h"
 
 class OptionsView : public QDialog {
@@ -18,6 +20,8 @@ private:
     int32_t maxMineCount();
     bool isValidMineCount();
     void checkValidMineCount();
+    // shows how many layouts the current settings have and what generating one costs
+    void updateFeasibility();
 
 protected:
     // we do not want the enter key to close our qdialog
@@ -35,14 +39,27 @@ private slots:
     void onSafeCheckChanged(Qt::CheckState value);
     void onClearCheckChanged(Qt::CheckState value);
     void onMarkCheckChanged(Qt::CheckState value);
+    void onAutoChordCheckChanged(Qt::CheckState value);
+    void onAutoFlagCheckChanged(Qt::CheckState value);
     void onSeedCheckChanged(Qt::CheckState value);
+    void onGeneratorCheckChanged(Qt::CheckState value);
+    void onCodeEditorChanged();
     void onDone();
 
+public slots:
+    void showEstimate(const WinRateEstimate& estimate);
+
 signals:
+    // every time the board settings change while the dialog is open, for a new estimate
+    void settingsEdited(const GameSettings& settings) const;
     void applySettings(const GameSettings& settings) const;
+    // instead of applySettings when a valid board code was entered
+    void applyBoardCode(const GameSettings& settings, const GameBoardCoord& anchor) const;
 
 private:
     Ui::Options* m_ui;
     QLabel* warn_label = nullptr;
     GameSettings m_settings = GameSettings();
+    GameBoardCoord m_anchor = { -1, -1 };
+    bool m_has_code = false;
 };
\ No newline at end of file
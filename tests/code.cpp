@@ -0,0 +1,133 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <QString>
+#include <QByteArray>
+#include <fmt/core.h>
+
+#include "model/code.h"
+#include "model/board.h"
+
+// encodes random board configurations as board codes and mine bitmaps, decodes them again
+// and checks that the decoded settings produce the very same board. then damages codes and
+// bitmaps and checks that they are refused. exits with 1 and prints the first mismatch if
+// anything is off
+// usage: MinesweeperTestCode [boards] [seed]
+
+namespace {
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    bool sameSquares(const GameBoard& board, const GameBoard& other) {
+        if (board.rowSize() != other.rowSize() || board.colSize() != other.colSize())
+            return false;
+        for (int32_t i = 0; i < board.rowSize(); i++) {
+            for (int32_t j = 0; j < board.colSize(); j++) {
+                if (board.getSquare({ i, j }) != other.getSquare({ i, j }))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void checkCode(const GameSettings& settings, const GameBoardCoord& anchor, const std::string& name) {
+        const QString code = encodeBoardCode(settings, anchor);
+        GameSettings decoded;
+        GameBoardCoord decoded_anchor = { 0, 0 };
+        check(decodeBoardCode(code, decoded, decoded_anchor), "decode the code " + name);
+        check(decoded.row_size == settings.row_size && decoded.col_size == settings.col_size
+            && decoded.num_mines == settings.num_mines && decoded.seed == settings.seed
+            && decoded.is_question_enabled == settings.is_question_enabled
+            && decoded.is_safe_first_move == settings.is_safe_first_move
+            && decoded.is_clear_first_move == settings.is_clear_first_move
+            && decoded.generator == settings.generator && decoded.is_set_seed, "settings of the code " + name);
+        check(decoded_anchor.row == anchor.row && decoded_anchor.col == anchor.col, "anchor of the code " + name);
+
+        // the whole point of a code: the same mines for whoever decodes it
+        if (anchor.row >= 0) {
+            GameBoard board(settings);
+            GameBoard replayed(decoded);
+            check(board.generateMines(anchor) && replayed.generateMines(decoded_anchor)
+                && sameSquares(board, replayed), "board of the code " + name);
+        }
+
+        // any changed byte breaks the checksum, the version or the base64
+        QByteArray bytes = code.toLatin1();
+        bytes[bytes.size() / 2] = (bytes[bytes.size() / 2] == 'A') ? 'B' : 'A';
+        check(!decodeBoardCode(QString::fromLatin1(bytes), decoded, decoded_anchor), "a damaged code " + name);
+    }
+
+    void checkBitmap(const GameSettings& settings, const GameBoardCoord& anchor, const std::string& name) {
+        GameBoard board(settings);
+        check(board.generateMines(anchor), "generate " + name);
+        const std::vector<uint8_t> bitmap = board.mineBitmap();
+        const QByteArray data = encodeMineBitmap(settings, bitmap);
+
+        GameSettings decoded;
+        std::vector<uint8_t> decoded_bitmap;
+        check(decodeMineBitmap(data, decoded, decoded_bitmap), "decode the bitmap " + name);
+        check(decoded.row_size == settings.row_size && decoded.col_size == settings.col_size
+            && decoded.num_mines == settings.num_mines && decoded_bitmap == bitmap, "settings of the bitmap " + name);
+
+        GameBoard loaded(decoded);
+        check(loaded.preloadMines(decoded_bitmap) && sameSquares(board, loaded), "board of the bitmap " + name);
+        check(loaded.mineBitmap() == bitmap, "bitmap of the loaded board " + name);
+
+        // a bitmap has to agree with its header
+        check(!decodeMineBitmap(data.mid(0, data.size() - 1), decoded, decoded_bitmap), "a truncated bitmap " + name);
+        QByteArray flipped = data;
+        flipped[flipped.size() - 1] = flipped[flipped.size() - 1] ^ 1;
+        check(!decodeMineBitmap(flipped, decoded, decoded_bitmap), "a bitmap with another mine count " + name);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const int32_t count = (argc > 1) ? std::atoi(argv[1]) : 500;
+    uint32_t random = (argc > 2) ? std::atoll(argv[2]) : 1;
+    auto next = [&random](int32_t bound) {
+        random = random * 1664525 + 1013904223;
+        return int32_t((random >> 8) % bound);
+    };
+
+    for (int32_t k = 0; k < count; k++) {
+        GameSettings settings;
+        settings.row_size = 1 + next(255);
+        settings.col_size = 1 + next(255);
+        settings.is_question_enabled = next(2);
+        settings.is_safe_first_move = next(2);
+        settings.is_clear_first_move = next(2);
+        settings.generator = next(2) ? GameGenerator::Xoshiro : GameGenerator::Mt19937;
+        settings.seed = random;
+        settings.is_set_seed = true;
+        // enough room for the clear zone, so every anchor works
+        const int32_t squares = settings.row_size * settings.col_size;
+        settings.num_mines = next(std::max(squares - 9, 1));
+        const GameBoardCoord anchor = { next(settings.row_size), next(settings.col_size) };
+        const std::string name = fmt::format("on {}x{}/{}", settings.row_size, settings.col_size, settings.num_mines);
+
+        checkCode(settings, anchor, name);
+        checkCode(settings, { -1, -1 }, name + " without an anchor");
+        checkBitmap(settings, anchor, name);
+    }
+
+    // sizes beyond a byte have no code, and an empty code decodes to nothing
+    GameSettings large;
+    large.row_size = 256;
+    large.col_size = 30;
+    large.num_mines = 99;
+    GameSettings decoded;
+    GameBoardCoord anchor = { 0, 0 };
+    check(encodeBoardCode(large, { 0, 0 }).isEmpty(), "a code for 256 rows");
+    check(!decodeBoardCode(QString(), decoded, anchor), "an empty code");
+
+    fmt::print("{{\"boards\": {}, \"failures\": {}}}\n", count, s_failures);
+    return s_failures ? 1 : 0;
+}
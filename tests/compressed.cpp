@@ -0,0 +1,112 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <fmt/core.h>
+
+#include "model/board.h"
+#include "model/compressed.h"
+
+// compresses generated boards and checks every square against the board, both after the
+// mines are placed and while the game is played through setSquare(), and that the copy
+// stays an order of magnitude smaller than the board itself. exits with 1 and prints the
+// first mismatch if anything is off. the memory is only checked on large boards, where a
+// copy is worth saving
+// usage: MinesweeperTestCompressed [seed]
+
+namespace {
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    void checkSquares(const CompressedBoard& compressed, const GameBoard& board, const std::string& when) {
+        check(compressed.rowSize() == board.rowSize() && compressed.colSize() == board.colSize(), "size " + when);
+        for (int32_t i = 0; i < board.rowSize(); i++) {
+            for (int32_t j = 0; j < board.colSize(); j++) {
+                if (compressed.getSquare({ i, j }) != board.getSquare({ i, j })) {
+                    check(false, fmt::format("square {} {} {}", i, j, when));
+                    return;
+                }
+            }
+        }
+    }
+
+    // the plain alternative: a copy of every square
+    double memoryRatio(const CompressedBoard& compressed, const GameBoard& board) {
+        return double(compressed.memoryUsage()) / (double(board.rowSize()) * board.colSize() * sizeof(GameBoardSquare));
+    }
+
+    void checkBoard(int32_t rows, int32_t cols, int32_t mines, uint32_t seed) {
+        GameSettings settings;
+        settings.row_size = rows;
+        settings.col_size = cols;
+        settings.num_mines = mines;
+        settings.seed = seed;
+        settings.is_set_seed = true;
+        const std::string name = fmt::format("on {}x{}/{}", rows, cols, mines);
+
+        GameBoard board(settings);
+        const GameBoardCoord first = { rows / 2, cols / 2 };
+        check(board.generateMines(first), "generate " + name);
+        CompressedBoard compressed(board);
+        checkSquares(compressed, board, "after generating " + name);
+        const bool is_large = int64_t(rows) * cols >= 256 * 256;
+        const double generated = memoryRatio(compressed, board);
+        check(!is_large || generated < 0.1, fmt::format("memory ratio {:.3f} after generating {}", generated, name));
+
+        // plays the board the way the view follows it: only the changed squares are set
+        GameState state;
+        state.is_first_reveal = false;
+        uint32_t random = seed;
+        double revealed = 0;
+        for (int32_t move = 0; move < 200 && !state.won && !state.lost; move++) {
+            board.clearChangedSquares();
+            const GameBoardCoord coord = (move == 0) ? first : GameBoardCoord{ int32_t(random % rows), int32_t((random >> 16) % cols) };
+            random = random * 1664525 + 1013904223;
+            if (board.getSquare(coord).is_mine) {
+                board.mark(coord, state);
+            } else {
+                board.reveal(coord, state);
+            }
+            for (const GameBoardCoord& changed : board.changedSquares())
+                compressed.setSquare(changed, board.getSquare(changed));
+            if (move == 0)
+                revealed = memoryRatio(compressed, board);
+        }
+        checkSquares(compressed, board, "while playing " + name);
+        check(!is_large || revealed < 0.1, fmt::format("memory ratio {:.3f} after the first reveal {}", revealed, name));
+        const double played = memoryRatio(compressed, board);
+
+        GameBoard copy(settings);
+        compressed.decompress(copy);
+        checkSquares(compressed, copy, "decompressed " + name);
+        compressed.assign(board);
+        checkSquares(compressed, board, "reassigned " + name);
+        fmt::print("{{\"board\": \"{}x{}/{}\", \"generated\": {:.4f}, \"revealed\": {:.4f}, \"played\": {:.4f}}}\n",
+            rows, cols, mines, generated, revealed, played);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const uint32_t seed = (argc > 1) ? std::atoll(argv[1]) : 1;
+
+    checkBoard(1000, 1000, 10000, seed);
+    checkBoard(480, 480, 2000, seed);
+    checkBoard(16, 30, 99, seed);
+
+    GameSettings empty;
+    empty.row_size = 0;
+    empty.col_size = 0;
+    empty.num_mines = 0;
+    CompressedBoard compressed{ GameBoard(empty) };
+    check(compressed.rowSize() == 0 && compressed.memoryUsage() == 0, "an empty board");
+
+    fmt::print("{{\"failures\": {}}}\n", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+#include <QString>
+#include <fmt/core.h>
+
+#include "model/board.h"
+#include "model/corpus.h"
+#include "model/analysis.h"
+
+// writes a corpus of generated boards, reads it back and checks every record against the
+// board it was written from. then writes headers that do not fit the file (a truncated
+// file, a count that would wrap, an unpadded record size) and checks that the reader
+// refuses them. exits with 1 and prints the first mismatch if anything is off
+// usage: MinesweeperTestCorpus [boards] [seed]
+
+namespace {
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    // overwrites size bytes of the file at offset, or truncates it there if data is null
+    void damage(const std::string& path, size_t offset, const void* data, size_t size) {
+        if (!data) {
+            std::filesystem::resize_file(path, offset);
+            return;
+        }
+        if (std::FILE* file = std::fopen(path.c_str(), "r+b")) {
+            std::fseek(file, offset, SEEK_SET);
+            std::fwrite(data, 1, size, file);
+            std::fclose(file);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const int32_t count = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    const uint32_t seed = (argc > 2) ? std::atoll(argv[2]) : 1;
+    const std::string path = (std::filesystem::temp_directory_path() / fmt::format("corpus-test-{}.mscp", seed)).string();
+
+    GameSettings settings;
+    settings.row_size = 16;
+    settings.col_size = 30;
+    settings.num_mines = 99;
+    settings.is_set_seed = true;
+    const GameBoardCoord anchor = { 8, 15 };
+
+    CorpusWriter writer;
+    check(writer.open(QString::fromStdString(path), settings), "open a new file");
+    std::vector<GameBoard> boards;
+    for (int32_t i = 0; i < count; i++) {
+        settings.seed = seed + i;
+        GameBoard& board = boards.emplace_back(settings);
+        check(board.generateMines(anchor) && writer.append(board, anchor), fmt::format("append board {}", i));
+    }
+
+    // a board of another size would not fill its record
+    GameSettings other = settings;
+    other.row_size = 30;
+    other.col_size = 16;
+    GameBoard transposed(other);
+    check(transposed.generateMines(anchor) && !writer.append(transposed, anchor), "append a board of another size");
+    check(writer.close(), "close the file");
+
+    CorpusReader reader;
+    check(reader.open(QString::fromStdString(path)), "open the file");
+    const CorpusHeader& header = reader.header();
+    check(header.row_size == 16 && header.col_size == 30 && header.num_mines == 99 && header.record_size % 8 == 0
+        && reader.size() == uint64_t(count), "the header");
+    for (int32_t i = 0; i < count && i < int32_t(reader.size()); i++) {
+        const GameBoard& board = boards[i];
+        const CorpusRecord& record = reader[i];
+        const BoardMetrics metrics = measureBoard(board);
+        bool same = record.seed == board.getSeed() && record.anchor_row == anchor.row && record.anchor_col == anchor.col
+            && record.bbbv == metrics.bbbv && record.openings == metrics.openings;
+        for (int32_t square = 0; same && square < 16 * 30; square++)
+            same = record.isMine(square) == board.getSquare({ square / 30, square % 30 }).is_mine;
+        if (!same) {
+            check(false, fmt::format("record {}", i));
+            break;
+        }
+    }
+    const uint32_t record_size = header.record_size;
+    reader.close();
+
+    // the smallest count whose records overflow 64 bits, which the record size multiplies
+    // into less than one record
+    const uint64_t wrapping = UINT64_MAX / record_size + 1;
+    damage(path, offsetof(CorpusHeader, count), &wrapping, sizeof(wrapping));
+    check(!reader.open(QString::fromStdString(path)), "a count that wraps");
+    const uint64_t real_count = count;
+    damage(path, offsetof(CorpusHeader, count), &real_count, sizeof(real_count));
+    check(reader.open(QString::fromStdString(path)), "the count restored");
+    reader.close();
+
+    const uint32_t unpadded = record_size - 4;
+    damage(path, offsetof(CorpusHeader, record_size), &unpadded, sizeof(unpadded));
+    check(!reader.open(QString::fromStdString(path)), "a record size that is not padded");
+    damage(path, offsetof(CorpusHeader, record_size), &record_size, sizeof(record_size));
+
+    // a writer that never closed leaves fewer records than the count
+    damage(path, sizeof(CorpusHeader) + size_t(count - 1) * record_size, nullptr, 0);
+    check(!reader.open(QString::fromStdString(path)), "a truncated file");
+
+    std::filesystem::remove(path);
+    fmt::print("{{\"boards\": {}, \"failures\": {}}}\n", count, s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#include <QByteArray>
+#include <fmt/core.h>
+
+#include "model/board.h"
+#include "model/delta.h"
+#include "model/tile.h"
+#include "model/protocol.h"
+
+// plays random games and streams every move to a spectator copy the way SpectatorHub does:
+// a keyframe first, then a delta of the squares each move changed. every frame goes through
+// the frame reader, and the copy has to match the board after each of them. a delta that
+// skips a sequence has to be refused without touching the copy, and the next keyframe has
+// to bring it back. exits with 1 and prints the first mismatch if anything is off
+// usage: MinesweeperTestDelta [games] [seed]
+
+namespace {
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    // splits frame back into its type and payload and applies it to copy
+    bool receive(const QByteArray& frame, SpectatorBoard& copy, uint32_t id) {
+        RaceFrameReader reader;
+        reader.append(frame);
+        RaceMessage type;
+        QByteArray payload;
+        uint32_t board = 0;
+        return reader.next(type, payload) && peekSpectatorBoard(payload, board) && board == id
+            && applySpectatorFrame(type, payload, copy);
+    }
+
+    bool sameBoard(const SpectatorBoard& copy, const SpectatorBoard& board) {
+        return copy.row_size == board.row_size && copy.col_size == board.col_size && copy.sequence == board.sequence
+            && copy.won == board.won && copy.lost == board.lost && copy.mines == board.mines && copy.tiles == board.tiles;
+    }
+
+    void checkGame(const GameSettings& settings, uint32_t& random, uint32_t id) {
+        auto next = [&random](int32_t bound) {
+            random = random * 1664525 + 1013904223;
+            return int32_t((random >> 8) % bound);
+        };
+
+        GameBoard board(settings);
+        GameState state;
+        state.mines = settings.num_mines;
+        SpectatorBoard sent;
+        sent.row_size = settings.row_size;
+        sent.col_size = settings.col_size;
+        sent.mines = state.mines;
+        sent.tiles.assign(settings.row_size * settings.col_size, uint8_t(BoardTile::Hidden));
+        SpectatorBoard copy;
+        check(receive(encodeSpectatorKeyframe(id, sent), copy, id) && sameBoard(copy, sent), fmt::format("keyframe of board {}", id));
+
+        std::vector<SpectatorChange> changes;
+        for (int32_t move = 0; move < 200 && !state.won && !state.lost; move++) {
+            board.clearChangedSquares();
+            const GameBoardCoord coord = { next(settings.row_size), next(settings.col_size) };
+            if (next(4)) {
+                board.reveal(coord, state);
+            } else {
+                board.mark(coord, state);
+            }
+
+            changes.clear();
+            for (const GameBoardCoord& changed : board.changedSquares()) {
+                const int32_t square = changed.row * settings.col_size + changed.col;
+                const uint8_t tile = boardTile(board.getSquare(changed));
+                if (sent.tiles[square] != tile) {
+                    sent.tiles[square] = tile;
+                    changes.push_back({ square, tile });
+                }
+            }
+            std::sort(changes.begin(), changes.end(), [](const SpectatorChange& a, const SpectatorChange& b) {
+                return a.square < b.square;
+            });
+            sent.sequence++;
+            sent.won = state.won;
+            sent.lost = state.lost;
+            sent.mines = state.mines;
+
+            const std::string name = fmt::format("move {} of board {}", move, id);
+            const QByteArray delta = encodeSpectatorDelta(id, sent, changes);
+            // every fifth move is lost on the way, which the next move has to notice
+            if (move % 5 == 4) {
+                SpectatorBoard next_copy = copy;
+                sent.sequence++;
+                check(!receive(encodeSpectatorDelta(id, sent, {}), next_copy, id) && sameBoard(next_copy, copy), "a delta after a lost one " + name);
+                check(receive(encodeSpectatorKeyframe(id, sent), copy, id) && sameBoard(copy, sent), "a keyframe after a lost delta " + name);
+                continue;
+            }
+            check(receive(delta, copy, id) && sameBoard(copy, sent), "delta of " + name);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const int32_t games = (argc > 1) ? std::atoi(argv[1]) : 100;
+    uint32_t random = (argc > 2) ? std::atoll(argv[2]) : 1;
+
+    // small boards, and the largest a race can have, where most deltas are runs
+    const GameSettings boards[3] = { { 9, 9, 10 }, { 16, 30, 99 }, { 255, 255, 3000 } };
+    for (int32_t game = 0; game < games; game++) {
+        GameSettings settings = boards[game % 3];
+        settings.seed = random;
+        settings.is_set_seed = true;
+        settings.is_question_enabled = game % 2;
+        checkGame(settings, random, game + 1);
+    }
+
+    fmt::print("{{\"games\": {}, \"failures\": {}}}\n", games, s_failures);
+    return s_failures ? 1 : 0;
+}
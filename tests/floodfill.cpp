@@ -0,0 +1,136 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <fmt/core.h>
+
+#include "model/board.h"
+
+// plays generated boards on both sides of the parallel threshold and checks every reveal
+// against a plain sequential flood fill, and the zero regions against a plain count. some
+// squares are marked before the game, so fills run both through the region labels and
+// through the parallel search. exits with 1 and prints the first mismatch if anything is off
+// usage: MinesweeperTestFloodfill [seed]
+
+namespace {
+
+    constexpr int32_t dir_row[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    constexpr int32_t dir_col[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    // what GameBoard::reveal does to a square that is not a mine, one square at a time
+    void floodfill(GameBoard& board, const GameBoardCoord& start) {
+        std::vector<GameBoardCoord> queue = { start };
+        board.getSquare(start).is_revealed = true;
+        while (!queue.empty()) {
+            const GameBoardCoord curr = queue.back();
+            queue.pop_back();
+            if (board.getSquare(curr).adjacent_mines)
+                continue;
+            for (int32_t k = 0; k < 8; k++) {
+                const GameBoardCoord adj = { curr.row + dir_row[k], curr.col + dir_col[k] };
+                if (adj.row < 0 || adj.col < 0 || adj.row >= board.rowSize() || adj.col >= board.colSize())
+                    continue;
+                GameBoardSquare& square = board.getSquare(adj);
+                if (square.is_mine || square.is_revealed || square.is_marked)
+                    continue;
+                square.is_revealed = true;
+                queue.push_back(adj);
+            }
+        }
+    }
+
+    // the connected regions of squares without a mine around them, by flood filling a copy
+    int32_t countRegions(GameBoard board) {
+        int32_t regions = 0;
+        for (int32_t i = 0; i < board.rowSize(); i++) {
+            for (int32_t j = 0; j < board.colSize(); j++) {
+                const GameBoardSquare& square = board.getSquare({ i, j });
+                if (square.is_mine || square.adjacent_mines || square.is_revealed)
+                    continue;
+                floodfill(board, { i, j });
+                regions++;
+            }
+        }
+        return regions;
+    }
+
+    void checkBoard(int32_t rows, int32_t cols, int32_t mines, uint32_t seed) {
+        GameSettings settings;
+        settings.row_size = rows;
+        settings.col_size = cols;
+        settings.num_mines = mines;
+        settings.seed = seed;
+        settings.is_set_seed = true;
+        const std::string name = fmt::format("on {}x{}/{}", rows, cols, mines);
+
+        GameBoard board(settings);
+        check(board.generateMines({ rows / 2, cols / 2 }), "generate " + name);
+        check(board.regionCount() == countRegions(board), "region count " + name);
+
+        // a mark inside a region keeps the whole region from opening by its label
+        uint32_t random = seed;
+        auto next = [&random](int32_t bound) {
+            random = random * 1664525 + 1013904223;
+            return int32_t((random >> 8) % bound);
+        };
+        for (int32_t k = 0; k < rows * cols / 2000 + 1; k++) {
+            GameBoardSquare& square = board.getSquare({ next(rows), next(cols) });
+            square.is_marked = !square.is_mine;
+        }
+        GameBoard expected = board;
+
+        GameState state;
+        state.is_first_reveal = false;
+        state.mines = mines;
+        int32_t reveals = 0;
+        for (int32_t move = 0; move < 400 && !state.won && !state.lost; move++) {
+            const GameBoardCoord coord = (move == 0) ? GameBoardCoord{ rows / 2, cols / 2 } : GameBoardCoord{ next(rows), next(cols) };
+            const GameBoardSquare& square = expected.getSquare(coord);
+            if (square.is_mine || square.is_marked || square.is_revealed)
+                continue;
+            board.reveal(coord, state);
+            floodfill(expected, coord);
+            reveals++;
+        }
+
+        int32_t revealed = 0;
+        for (int32_t i = 0; i < rows; i++) {
+            for (int32_t j = 0; j < cols; j++) {
+                const bool is_revealed = board.getSquare({ i, j }).is_revealed;
+                revealed += is_revealed;
+                if (is_revealed != expected.getSquare({ i, j }).is_revealed) {
+                    check(false, fmt::format("square {} {} {}", i, j, name));
+                    i = rows;
+                    break;
+                }
+            }
+        }
+        fmt::print("{{\"board\": \"{}x{}/{}\", \"regions\": {}, \"reveals\": {}, \"revealed\": {}}}\n",
+            rows, cols, mines, board.regionCount(), reveals, revealed);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const uint32_t seed = (argc > 1) ? std::atoll(argv[1]) : 1;
+
+    // below the parallel threshold, then sparse, dense and thin boards above it
+    checkBoard(300, 300, 9000, seed);
+    checkBoard(1000, 1000, 10000, seed);
+    checkBoard(600, 700, 60000, seed);
+    checkBoard(2, 200000, 4000, seed);
+    // a single row or column is a range of one number for the generator
+    checkBoard(1, 300000, 3000, seed);
+    checkBoard(300, 1, 30, seed);
+
+    fmt::print("{{\"failures\": {}}}\n", s_failures);
+    return s_failures ? 1 : 0;
+}
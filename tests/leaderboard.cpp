@@ -0,0 +1,107 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+
+#include <QString>
+#include <fmt/core.h>
+
+#include "model/leaderboard.h"
+
+// inserts random entries into a fresh leaderboard file and checks every rank, count and
+// page against a sorted vector of the same keys, before and after reopening the file. then
+// damages the tree and checks that reads stay inside the file and inserts are refused.
+// exits with 1 and prints the first mismatch if anything is off
+// usage: MinesweeperTestLeaderboard [entries] [seed]
+
+namespace {
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    // the keys of a configuration in rank order
+    std::vector<LeaderboardKey> ranked(const std::vector<LeaderboardKey>& keys, uint64_t config) {
+        std::vector<LeaderboardKey> result;
+        for (const LeaderboardKey& key : keys) {
+            if (key.config == config)
+                result.push_back(key);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void checkPages(const Leaderboard& board, const std::vector<LeaderboardKey>& keys, uint64_t config) {
+        const std::vector<LeaderboardKey> expected = ranked(keys, config);
+        check(board.count(config) == int64_t(expected.size()), fmt::format("count of config {}", config));
+        for (int64_t first : { int64_t(0), int64_t(1), int64_t(expected.size() / 3), int64_t(expected.size()) - 5 }) {
+            const std::vector<LeaderboardEntry> page = board.entries(config, std::max<int64_t>(first, 0), 100);
+            const int64_t begin = std::max<int64_t>(first, 0);
+            const int64_t size = std::min<int64_t>(100, expected.size() - begin);
+            check(int64_t(page.size()) == size, fmt::format("page size of config {} at {}", config, begin));
+            for (int64_t i = 0; i < std::min<int64_t>(size, page.size()); i++)
+                check(page[i].key == expected[begin + i], fmt::format("entry {} of config {}", begin + i, config));
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const int32_t count = (argc > 1) ? std::atoi(argv[1]) : 20000;
+    const uint32_t seed = (argc > 2) ? std::atoll(argv[2]) : 1;
+    const std::string path = (std::filesystem::temp_directory_path() / fmt::format("leaderboard-test-{}.mslb", seed)).string();
+    std::filesystem::remove(path);
+
+    // few configurations and few distinct times, so equal times and splits of pages that
+    // hold several configurations both happen a lot
+    const uint64_t configs[] = { 1, 2, 3, 1ull << 40 };
+    std::mt19937 rng(seed);
+    std::vector<LeaderboardKey> keys;
+    Leaderboard board;
+    check(board.open(QString::fromStdString(path)), "open a new file");
+    for (int32_t i = 0; i < count && board.isOpen(); i++) {
+        LeaderboardEntry entry = {};
+        entry.key = { configs[rng() % 4], uint32_t(rng() % 500), 0 };
+        const int64_t rank = board.insert(entry);
+        entry.key.order = i;
+        keys.push_back(entry.key);
+        const std::vector<LeaderboardKey> expected = ranked(keys, entry.key.config);
+        const int64_t position = std::lower_bound(expected.begin(), expected.end(), entry.key) - expected.begin();
+        check(rank == position + 1, fmt::format("rank of insert {}", i));
+    }
+    for (uint64_t config : configs)
+        checkPages(board, keys, config);
+    check(board.count(4) == 0 && board.entries(4, 0, 10).empty(), "an empty configuration");
+
+    board.close();
+    check(board.open(QString::fromStdString(path)), "reopen the file");
+    for (uint64_t config : configs)
+        checkPages(board, keys, config);
+
+    // a child index far outside the file, in the root page: the second page of the file
+    // is the first root, and the root is an inner page once there are several leaves
+    board.close();
+    if (std::FILE* file = std::fopen(path.c_str(), "r+b")) {
+        uint32_t root = 0;
+        std::fseek(file, 16, SEEK_SET);
+        check(std::fread(&root, sizeof(root), 1, file) == 1, "read the root");
+        const uint32_t garbage = 0x7FFFFFFF;
+        std::fseek(file, long(root) * 4096 + 8, SEEK_SET);
+        std::fwrite(&garbage, sizeof(garbage), 1, file);
+        std::fclose(file);
+    }
+    check(board.open(QString::fromStdString(path)), "open the damaged file");
+    for (uint64_t config : configs)
+        board.entries(config, 0, 100);
+    check(board.insert({}) == 0 && !board.isOpen(), "an insert into the damaged file");
+
+    std::filesystem::remove(path);
+    fmt::print("{{\"entries\": {}, \"failures\": {}}}\n", count, s_failures);
+    return s_failures ? 1 : 0;
+}
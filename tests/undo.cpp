@@ -0,0 +1,104 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <fmt/core.h>
+
+#include "model/board.h"
+
+// plays random reveals, chords and marks and undoes and redoes every move right after it,
+// checking that the board and the state come back exactly. at the end of a game the whole
+// history is undone down to the untouched board and redone up to the end. exits with 1
+// and prints the first mismatch if anything is off
+// usage: MinesweeperTestUndo [games] [seed]
+
+namespace {
+
+    int32_t s_failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition && s_failures++ == 0)
+            fmt::print(stderr, "mismatch: {}\n", what);
+    }
+
+    struct Position {
+        std::vector<GameBoardSquare> squares;
+        GameState state;
+        bool operator==(const Position& other) const = default;
+    };
+
+    // the timer is left alone by undo and redo, so it takes no part
+    Position position(const GameBoard& board, const GameState& state) {
+        Position result;
+        for (int32_t i = 0; i < board.rowSize(); i++) {
+            for (int32_t j = 0; j < board.colSize(); j++)
+                result.squares.push_back(board.getSquare({ i, j }));
+        }
+        result.state = state;
+        result.state.timer = -1;
+        return result;
+    }
+
+    void checkGame(const GameSettings& settings, uint32_t& random, int32_t game) {
+        auto next = [&random](int32_t bound) {
+            random = random * 1664525 + 1013904223;
+            return int32_t((random >> 8) % bound);
+        };
+
+        GameBoard board(settings);
+        GameState state;
+        state.mines = settings.num_mines;
+        const Position start = position(board, state);
+        int32_t moves = 0;
+        for (int32_t move = 0; move < 300 && !state.won && !state.lost; move++) {
+            const GameBoardCoord coord = { next(settings.row_size), next(settings.col_size) };
+            const Position before = position(board, state);
+            // mostly reveals, which also chord on revealed numbers
+            if (next(4)) {
+                board.reveal(coord, state);
+            } else {
+                board.mark(coord, state);
+            }
+            const Position after = position(board, state);
+            if (after == before)
+                continue;
+
+            moves++;
+            const std::string name = fmt::format("move {} of game {}", move, game);
+            check(board.undo(state) && position(board, state) == before, "undo " + name);
+            check(board.redo(state) && position(board, state) == after, "redo " + name);
+            check(!board.canRedo(), "nothing left to redo after " + name);
+        }
+
+        const Position end = position(board, state);
+        int32_t undone = 0;
+        while (board.undo(state))
+            undone++;
+        check(position(board, state) == start, fmt::format("undo all of game {}", game));
+        while (board.redo(state))
+            undone--;
+        check(position(board, state) == end && !undone, fmt::format("redo all of game {}", game));
+        check(moves > 0, fmt::format("a move in game {}", game));
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const int32_t games = (argc > 1) ? std::atoi(argv[1]) : 200;
+    uint32_t random = (argc > 2) ? std::atoll(argv[2]) : 1;
+
+    // the three usual sizes, with and without question marks and a clear first move
+    const GameSettings boards[3] = { { 9, 9, 10 }, { 16, 16, 40 }, { 16, 30, 99 } };
+    for (int32_t game = 0; game < games; game++) {
+        GameSettings settings = boards[game % 3];
+        settings.seed = random;
+        settings.is_set_seed = true;
+        settings.is_question_enabled = game % 2;
+        settings.is_clear_first_move = game % 5 == 0;
+        checkGame(settings, random, game);
+    }
+
+    fmt::print("{{\"games\": {}, \"failures\": {}}}\n", games, s_failures);
+    return s_failures ? 1 : 0;
+}
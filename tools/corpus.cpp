@@ -0,0 +1,109 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+
+#include "model/data.h"
+#include "model/board.h"
+#include "model/corpus.h"
+
+// writes and summarises board corpus files (see model/corpus.h)
+// usage: MinesweeperCorpus generate <file> <count> [rows cols mines [first seed]]
+//        MinesweeperCorpus stats <file>
+
+namespace {
+
+    int generate(int argc, char** argv) {
+        GameSettings settings;
+        settings.row_size = (argc > 4) ? std::atoi(argv[4]) : 16;
+        settings.col_size = (argc > 5) ? std::atoi(argv[5]) : 30;
+        settings.num_mines = (argc > 6) ? std::atoi(argv[6]) : 99;
+        const int64_t count = std::atoll(argv[3]);
+        const uint32_t first_seed = (argc > 7) ? std::atoll(argv[7]) : 0;
+
+        CorpusWriter writer;
+        if (!writer.open(argv[2], settings)) {
+            fmt::print(stderr, "could not open {} (boards are limited to 255 rows or columns and 65535 squares)\n", argv[2]);
+            return 1;
+        }
+
+        // every layout is generated around the centre, the usual opening click
+        const GameBoardCoord anchor = { settings.row_size / 2, settings.col_size / 2 };
+        GameBoard board(settings);
+        for (int64_t i = 0; i < count; i++) {
+            settings.seed = first_seed + i;
+            board.reset(settings);
+            if (!board.generateMines(anchor)) {
+                fmt::print(stderr, "{} mines do not fit a {}x{} board\n", settings.num_mines, settings.row_size, settings.col_size);
+                return 1;
+            }
+            if (!writer.append(board, anchor)) {
+                fmt::print(stderr, "could not write to {}\n", argv[2]);
+                return 1;
+            }
+        }
+
+        return writer.close() ? 0 : 1;
+    }
+
+    int stats(char** argv) {
+        CorpusReader reader;
+        if (!reader.open(argv[2])) {
+            fmt::print(stderr, "could not read {}\n", argv[2]);
+            return 1;
+        }
+
+        // a single pass over the mapped records; only the histograms are allocated
+        const CorpusHeader& header = reader.header();
+        const size_t squares = size_t(header.row_size) * header.col_size;
+        std::vector<uint64_t> bbbv(squares + 1, 0);
+        std::vector<uint64_t> openings(squares + 1, 0);
+        double bbbv_sum = 0, openings_sum = 0;
+        for (uint64_t i = 0; i < reader.size(); i++) {
+            const CorpusRecord& record = reader[i];
+            // a damaged file may hold anything
+            if (record.bbbv >= bbbv.size() || record.openings >= openings.size()) {
+                fmt::print(stderr, "record {} of {} is damaged\n", i, argv[2]);
+                return 1;
+            }
+            bbbv[record.bbbv]++;
+            openings[record.openings]++;
+            bbbv_sum += record.bbbv;
+            openings_sum += record.openings;
+        }
+
+        auto trim = [](std::vector<uint64_t>& histogram) {
+            while (!histogram.empty() && !histogram.back())
+                histogram.pop_back();
+        };
+        trim(bbbv);
+        trim(openings);
+
+        const double boards = std::max<uint64_t>(reader.size(), 1);
+        fmt::print(
+            "{{\"rows\": {}, \"cols\": {}, \"mines\": {}, \"boards\": {}, \"bbbv_mean\": {:.3f}, "
+            "\"openings_mean\": {:.3f}, \"bbbv_histogram\": [{}], \"openings_histogram\": [{}]}}\n",
+            header.row_size, header.col_size, header.num_mines, reader.size(),
+            bbbv_sum / boards, openings_sum / boards,
+            fmt::join(bbbv, ", "), fmt::join(openings, ", ")
+        );
+        return 0;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const std::string command = (argc > 1) ? argv[1] : "";
+    if (command == "generate" && argc > 3)
+        return generate(argc, argv);
+    if (command == "stats" && argc > 2)
+        return stats(argv);
+
+    fmt::print(stderr, "usage: {0} generate <file> <count> [rows cols mines [first seed]]\n"
+                       "       {0} stats <file>\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,258 @@
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QLocalSocket>
+#include <fmt/core.h>
+
+#include "app/server.h"
+#include "app/spectator.h"
+#include "model/data.h"
+#include "model/board.h"
+#include "model/code.h"
+#include "model/protocol.h"
+#include "model/delta.h"
+
+// runs a race server, or measures one with many simulated players over loopback
+// usage: MinesweeperRace serve [port [rows cols mines [seed]]]
+//        MinesweeperRace load <host> <port> <players> <seconds>
+//        MinesweeperRace spectate <port> <spectators> <seconds>
+// serve prints a json line with the player count and move rate every second, and streams
+// the boards to spectators on the local socket minesweeper-race-<port>. load keeps every
+// player playing winning games back to back (reconnecting after each one) and prints one
+// json line with the throughput and latency it saw. spectate follows the stream with many
+// local spectators and prints what one of them received
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    int serve(int argc, char** argv) {
+        GameSettings settings;
+        settings.row_size = (argc > 3) ? std::atoi(argv[3]) : 16;
+        settings.col_size = (argc > 4) ? std::atoi(argv[4]) : 30;
+        settings.num_mines = (argc > 5) ? std::atoi(argv[5]) : 99;
+        settings.seed = (argc > 6) ? std::atoll(argv[6]) : std::random_device()();
+        settings.is_set_seed = true;
+        const quint16 port = (argc > 2) ? std::atoi(argv[2]) : 7355;
+        if (settings.row_size < 1 || settings.row_size > 255 || settings.col_size < 1 || settings.col_size > 255) {
+            fmt::print(stderr, "a race board has 1 to 255 rows and columns\n");
+            return 1;
+        }
+
+        RaceServer server(settings);
+        if (!server.listen(QHostAddress::Any, port))
+            return 1;
+        SpectatorHub spectators;
+        if (spectators.listen(QString("minesweeper-race-%1").arg(port)))
+            server.setSpectators(&spectators);
+
+        uint64_t last_moves = 0;
+        QTimer report;
+        report.callOnTimeout([&] {
+            fmt::print("{{\"players\": {}, \"moves_per_s\": {}}}\n", server.players(), server.moves() - last_moves);
+            std::fflush(stdout);
+            last_moves = server.moves();
+        });
+        report.start(1000);
+        return QCoreApplication::exec();
+    }
+
+    // every player of a race has the same board, so the moves of a winning game are worked
+    // out once: the anchor first, then every safe square that is still closed
+    std::vector<GameBoardCoord> winningMoves(const QString& code) {
+        GameSettings settings;
+        GameBoardCoord anchor;
+        if (!decodeBoardCode(code, settings, anchor) || anchor.row < 0)
+            return {};
+
+        GameBoard board(settings);
+        GameState state;
+        board.preloadMines(anchor);
+        std::vector<GameBoardCoord> squares;
+        for (int32_t i = 0; i < settings.row_size; i++) {
+            for (int32_t j = 0; j < settings.col_size; j++) {
+                if (!board.getSquare({ i, j }).is_mine)
+                    squares.push_back({ i, j });
+            }
+        }
+        std::shuffle(squares.begin(), squares.end(), std::mt19937(settings.seed));
+        squares.insert(squares.begin(), anchor);
+
+        std::vector<GameBoardCoord> moves;
+        for (const GameBoardCoord& coord : squares) {
+            if (board.getSquare(coord).is_revealed)
+                continue;
+            board.reveal(coord, state);
+            moves.push_back(coord);
+        }
+        return moves;
+    }
+
+    struct LoadPlayer {
+        QTcpSocket socket;
+        RaceFrameReader reader;
+        size_t next = 0; // index into the winning moves
+        Clock::time_point sent;
+    };
+
+    int load(char** argv) {
+        const QString host = argv[2];
+        const quint16 port = std::atoi(argv[3]);
+        const int32_t count = std::atoi(argv[4]);
+        const double seconds = std::atof(argv[5]);
+
+        std::vector<GameBoardCoord> moves;
+        std::vector<uint32_t> latencies_us;
+        uint64_t games = 0, rejected = 0;
+        std::vector<std::unique_ptr<LoadPlayer>> players;
+
+        // one move in flight per player, the next one is sent when the answer arrives
+        auto sendNext = [&](LoadPlayer& player) {
+            player.sent = Clock::now();
+            player.socket.write(encodeRaceMove({ RaceMove::Reveal, moves[player.next++] }));
+        };
+
+        auto onReadyRead = [&](LoadPlayer& player) {
+            player.reader.append(player.socket.readAll());
+            RaceMessage type;
+            QByteArray payload;
+            while (player.reader.next(type, payload)) {
+                RaceWelcome welcome;
+                RaceProgress progress;
+                if (type == RaceMessage::Welcome && decodeRaceWelcome(payload, welcome)) {
+                    if (moves.empty())
+                        moves = winningMoves(welcome.code);
+                    if (moves.empty()) {
+                        fmt::print(stderr, "the server sent an unusable board code\n");
+                        QCoreApplication::exit(1);
+                        return;
+                    }
+                    player.next = 0;
+                    sendNext(player);
+                } else if (type == RaceMessage::Progress && decodeRaceProgress(payload, progress)) {
+                    latencies_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - player.sent).count());
+                    rejected += progress.rejected;
+                    if (progress.won || progress.lost || player.next == moves.size()) {
+                        // a new connection is a new player with a fresh board
+                        games++;
+                        player.reader = RaceFrameReader();
+                        player.socket.abort();
+                        player.socket.connectToHost(host, port);
+                        return;
+                    }
+                    sendNext(player);
+                }
+            }
+        };
+
+        for (int32_t i = 0; i < count; i++) {
+            players.push_back(std::make_unique<LoadPlayer>());
+            LoadPlayer* player = players.back().get();
+            QObject::connect(&player->socket, &QTcpSocket::connected, [player] {
+                player->socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            });
+            QObject::connect(&player->socket, &QTcpSocket::readyRead, [&onReadyRead, player] { onReadyRead(*player); });
+            player->socket.connectToHost(host, port);
+        }
+
+        const Clock::time_point start = Clock::now();
+        QTimer::singleShot(int(seconds * 1000), [] { QCoreApplication::exit(0); });
+        const int result = QCoreApplication::exec();
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        for (const std::unique_ptr<LoadPlayer>& player : players)
+            player->socket.abort();
+
+        std::sort(latencies_us.begin(), latencies_us.end());
+        auto percentile = [&](double p) {
+            return latencies_us.empty() ? 0 : latencies_us[std::min<size_t>(latencies_us.size() - 1, p * latencies_us.size())];
+        };
+        fmt::print(
+            "{{\"players\": {}, \"seconds\": {:.3f}, \"moves\": {}, \"moves_per_s\": {:.0f}, \"games\": {}, "
+            "\"rejected\": {}, \"latency_p50_us\": {}, \"latency_p99_us\": {}}}\n",
+            count, elapsed, latencies_us.size(), latencies_us.size() / elapsed, games,
+            rejected, percentile(0.5), percentile(0.99)
+        );
+        return result;
+    }
+
+    struct Spectator {
+        QLocalSocket socket;
+        RaceFrameReader reader;
+        std::unordered_map<uint32_t, SpectatorBoard> boards;
+    };
+
+    int spectate(char** argv) {
+        const QString name = QString("minesweeper-race-%1").arg(argv[2]);
+        const int32_t count = std::atoi(argv[3]);
+        const double seconds = std::atof(argv[4]);
+
+        // every spectator decodes everything, but only the first one is counted, since
+        // they all receive the same stream
+        uint64_t bytes = 0, keyframes = 0, deltas = 0, errors = 0;
+        std::vector<std::unique_ptr<Spectator>> spectators;
+        for (int32_t i = 0; i < count; i++) {
+            spectators.push_back(std::make_unique<Spectator>());
+            Spectator* spectator = spectators.back().get();
+            const bool is_counted = (i == 0);
+            QObject::connect(&spectator->socket, &QLocalSocket::readyRead, [&, spectator, is_counted] {
+                const QByteArray data = spectator->socket.readAll();
+                spectator->reader.append(data);
+                bytes += is_counted ? data.size() : 0;
+                RaceMessage type;
+                QByteArray payload;
+                uint32_t id = 0;
+                while (spectator->reader.next(type, payload)) {
+                    const bool ok = peekSpectatorBoard(payload, id) && applySpectatorFrame(type, payload, spectator->boards[id]);
+                    if (is_counted) {
+                        keyframes += (type == RaceMessage::Keyframe);
+                        deltas += (type == RaceMessage::Delta);
+                        errors += !ok;
+                    }
+                }
+            });
+            spectator->socket.connectToServer(name);
+        }
+
+        const Clock::time_point start = Clock::now();
+        QTimer::singleShot(int(seconds * 1000), [] { QCoreApplication::exit(0); });
+        const int result = QCoreApplication::exec();
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const size_t boards = spectators.empty() ? 0 : spectators.front()->boards.size();
+        fmt::print(
+            "{{\"spectators\": {}, \"seconds\": {:.3f}, \"boards\": {}, \"keyframes\": {}, \"deltas\": {}, "
+            "\"errors\": {}, \"bytes_per_s\": {:.0f}, \"bytes_per_frame\": {:.1f}}}\n",
+            count, elapsed, boards, keyframes, deltas, errors,
+            bytes / elapsed, double(bytes) / std::max<uint64_t>(keyframes + deltas, 1)
+        );
+        return result;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const std::string command = (argc > 1) ? argv[1] : "";
+    if (command == "serve")
+        return serve(argc, argv);
+    if (command == "load" && argc > 5)
+        return load(argv);
+    if (command == "spectate" && argc > 4)
+        return spectate(argv);
+
+    fmt::print(stderr, "usage: {0} serve [port [rows cols mines [seed]]]\n"
+                       "       {0} load <host> <port> <players> <seconds>\n"
+                       "       {0} spectate <port> <spectators> <seconds>\n", argv[0]);
+    return 1;
+}